@@ -1,16 +1,29 @@
 #include "devices/input.h"
 #include <debug.h>
-#include "devices/intq.h"
+#include "devices/ring.h"
 #include "devices/serial.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
 
-/* Stores keys from the keyboard and serial port. */
-static struct intq buffer;
+/* Input buffer size, in keys. */
+#define INPUT_BUFSIZE 256
+
+/* Stores keys from the keyboard and serial port.  The keyboard
+   and serial interrupt handlers are its producer; they never run
+   at the same time.  Threads reading keys are its consumer, one
+   at a time under consumer_lock. */
+static struct ring buffer;
+static uint8_t buffer_keys[INPUT_BUFSIZE];
+static struct lock consumer_lock;
+
+static void notify (void);
 
 /* Initializes the input buffer. */
 void
 input_init (void) 
 {
-  intq_init (&buffer);
+  ring_init (&buffer, buffer_keys, 1, INPUT_BUFSIZE);
+  lock_init (&consumer_lock);
 }
 
 /* Adds a key to the input buffer.
@@ -19,28 +32,74 @@ void
 input_putc (uint8_t key) 
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  ASSERT (!intq_full (&buffer));
+  ASSERT (!ring_full (&buffer));
 
-  intq_putc (&buffer, key);
+  ring_put (&buffer, &key, 1);
   serial_notify ();
 }
 
+/* Adds the SIZE keys in KEYS to the input buffer.
+   Interrupts must be off and the buffer must have room for
+   them. */
+void
+input_putbuf (const uint8_t *keys, size_t size) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (size <= ring_room (&buffer));
+
+  ring_put (&buffer, keys, size);
+  serial_notify ();
+}
+
+/* Returns the number of keys the input buffer has room for.
+   Interrupts must be off. */
+size_t
+input_room (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return ring_room (&buffer);
+}
+
 /* Retrieves a key from the input buffer.
    If the buffer is empty, waits for a key to be pressed. */
 uint8_t
 input_getc (void) 
 {
-  enum intr_level old_level;
   uint8_t key;
 
-  old_level = intr_disable ();
-  key = intq_getc (&buffer);
-  serial_notify ();
-  intr_set_level (old_level);
-  
+  input_getbuf (&key, 1, true);
   return key;
 }
 
+/* Retrieves up to SIZE keys from the input buffer into BUF and
+   returns the number retrieved.  If BLOCK is true and the buffer
+   is empty, waits for at least one key to be pressed; otherwise
+   only keys that are already buffered are returned, so the
+   result may be 0. */
+size_t
+input_getbuf (uint8_t *buf, size_t size, bool block) 
+{
+  size_t cnt;
+
+  lock_acquire (&consumer_lock);
+  if (block && size > 0)
+    ring_wait_not_empty (&buffer);
+  cnt = ring_get (&buffer, buf, size);
+  lock_release (&consumer_lock);
+
+  if (cnt > 0)
+    notify ();
+  return cnt;
+}
+
+/* Returns the number of keys that can be retrieved from the
+   input buffer without waiting. */
+size_t
+input_ready (void) 
+{
+  return ring_cnt (&buffer);
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -48,5 +107,15 @@ bool
 input_full (void) 
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  return intq_full (&buffer);
+  return ring_full (&buffer);
+}
+
+/* Lets the serial driver resume receiving now that the buffer
+   has room again. */
+static void
+notify (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  serial_notify ();
+  intr_set_level (old_level);
 }
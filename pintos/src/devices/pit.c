@@ -11,9 +11,6 @@
 #define PIT_PORT_CONTROL          0x43                /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL))  /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
-
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
 
@@ -81,3 +78,38 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Programs channel 0 to raise interrupt line 0 once, COUNT PIT
+   cycles from now, and then stay quiet (mode 0, "interrupt on
+   terminal count").  A COUNT of 0 means 65536.  Channel 0 stays
+   in this mode until pit_configure_channel() is called again. */
+void
+pit_oneshot (uint16_t count)
+{
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, 0x30);
+  outb (PIT_PORT_COUNTER (0), count);
+  outb (PIT_PORT_COUNTER (0), count >> 8);
+  intr_set_level (old_level);
+}
+
+/* Returns the current value of CHANNEL's down-counter, latched
+   so that the two byte reads are consistent. */
+uint16_t
+pit_read_count (int channel)
+{
+  enum intr_level old_level;
+  uint16_t count;
+
+  ASSERT (channel == 0 || channel == 2);
+
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, channel << 6);
+  count = inb (PIT_PORT_COUNTER (channel));
+  count |= inb (PIT_PORT_COUNTER (channel)) << 8;
+  intr_set_level (old_level);
+
+  return count;
+}
@@ -0,0 +1,173 @@
+#include "devices/ring.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+static void copy_in (struct ring *, size_t pos, const uint8_t *, size_t cnt);
+static void copy_out (const struct ring *, size_t pos, uint8_t *, size_t cnt);
+static void wait (struct ring *, struct list *waiters, bool (*blocked) (const struct ring *));
+static void wake (struct list *waiters);
+
+/* Initializes R to hold up to ELEM_CNT elements of ELEM_SIZE
+   bytes each in BUF, which must be ELEM_SIZE * ELEM_CNT bytes
+   long.  ELEM_CNT must be a power of 2. */
+void
+ring_init (struct ring *r, void *buf, size_t elem_size, size_t elem_cnt) 
+{
+  ASSERT (r != NULL);
+  ASSERT (buf != NULL);
+  ASSERT (elem_size > 0);
+  ASSERT (elem_cnt > 0 && (elem_cnt & (elem_cnt - 1)) == 0);
+
+  r->buf = buf;
+  r->elem_size = elem_size;
+  r->elem_cnt = elem_cnt;
+  r->head = r->tail = 0;
+  list_init (&r->not_empty);
+  list_init (&r->not_full);
+}
+
+/* Returns the number of elements in R. */
+size_t
+ring_cnt (const struct ring *r) 
+{
+  return r->head - r->tail;
+}
+
+/* Returns the number of elements that can be put into R. */
+size_t
+ring_room (const struct ring *r) 
+{
+  return r->elem_cnt - ring_cnt (r);
+}
+
+/* Returns true if R holds no elements. */
+bool
+ring_empty (const struct ring *r) 
+{
+  return ring_cnt (r) == 0;
+}
+
+/* Returns true if R has no room for another element. */
+bool
+ring_full (const struct ring *r) 
+{
+  return ring_room (r) == 0;
+}
+
+/* Puts up to CNT elements from ELEMS into R without waiting and
+   returns the number put, which is less than CNT if R fills up.
+   Wakes any threads waiting for data.  Must only be called by
+   R's producer. */
+size_t
+ring_put (struct ring *r, const void *elems, size_t cnt) 
+{
+  size_t head = r->head;
+
+  if (cnt > ring_room (r))
+    cnt = ring_room (r);
+  if (cnt == 0)
+    return 0;
+
+  copy_in (r, head, elems, cnt);
+  barrier ();
+  r->head = head + cnt;
+
+  if (!list_empty (&r->not_empty))
+    wake (&r->not_empty);
+  return cnt;
+}
+
+/* Gets up to CNT elements from R into ELEMS without waiting and
+   returns the number got, which is less than CNT if R runs out.
+   Wakes any threads waiting for room.  Must only be called by
+   R's consumer. */
+size_t
+ring_get (struct ring *r, void *elems, size_t cnt) 
+{
+  size_t tail = r->tail;
+
+  if (cnt > ring_cnt (r))
+    cnt = ring_cnt (r);
+  if (cnt == 0)
+    return 0;
+
+  copy_out (r, tail, elems, cnt);
+  barrier ();
+  r->tail = tail + cnt;
+
+  if (!list_empty (&r->not_full))
+    wake (&r->not_full);
+  return cnt;
+}
+
+/* Waits until R holds at least one element.  Must not be called
+   from an interrupt handler. */
+void
+ring_wait_not_empty (struct ring *r) 
+{
+  wait (r, &r->not_empty, ring_empty);
+}
+
+/* Waits until R has room for at least one element.  Must not be
+   called from an interrupt handler. */
+void
+ring_wait_not_full (struct ring *r) 
+{
+  wait (r, &r->not_full, ring_full);
+}
+
+/* Copies CNT elements from ELEMS into R's buffer starting at
+   element POS, wrapping around its end. */
+static void
+copy_in (struct ring *r, size_t pos, const uint8_t *elems, size_t cnt) 
+{
+  size_t ofs = pos & (r->elem_cnt - 1);
+  size_t first = r->elem_cnt - ofs < cnt ? r->elem_cnt - ofs : cnt;
+
+  memcpy (r->buf + ofs * r->elem_size, elems, first * r->elem_size);
+  memcpy (r->buf, elems + first * r->elem_size, (cnt - first) * r->elem_size);
+}
+
+/* Copies CNT elements starting at element POS of R's buffer
+   into ELEMS, wrapping around its end. */
+static void
+copy_out (const struct ring *r, size_t pos, uint8_t *elems, size_t cnt) 
+{
+  size_t ofs = pos & (r->elem_cnt - 1);
+  size_t first = r->elem_cnt - ofs < cnt ? r->elem_cnt - ofs : cnt;
+
+  memcpy (elems, r->buf + ofs * r->elem_size, first * r->elem_size);
+  memcpy (elems + first * r->elem_size, r->buf, (cnt - first) * r->elem_size);
+}
+
+/* Sleeps on WAITERS for as long as BLOCKED(R) is true.  Checking
+   and going to sleep happen with interrupts off, so a wakeup
+   from the other side cannot slip in between. */
+static void
+wait (struct ring *r, struct list *waiters, bool (*blocked) (const struct ring *)) 
+{
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  while (blocked (r))
+    {
+      list_push_back (waiters, &thread_current ()->elem);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+}
+
+/* Wakes every thread on WAITERS; each rechecks its condition. */
+static void
+wake (struct list *waiters) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  while (!list_empty (waiters))
+    thread_unblock (list_entry (list_pop_front (waiters), struct thread, elem));
+  intr_set_level (old_level);
+}
@@ -0,0 +1,48 @@
+#ifndef DEVICES_RING_H
+#define DEVICES_RING_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A single-producer, single-consumer ring buffer of fixed-size
+   elements, for passing data from interrupt handlers to kernel
+   threads (or the other way around) in batches.
+
+   Exactly one context may put into a given ring and exactly one
+   may get from it at a time; callers with several producers or
+   several consumers must serialize them, e.g. with a lock.  An
+   external interrupt handler counts as a single producer or
+   consumer, since external interrupts do not nest.  Under that
+   rule puts and gets need no lock and do not turn interrupts
+   off: the producer only advances HEAD and the consumer only
+   advances TAIL, each after its data copy is complete.
+
+   Any number of threads may wait for a ring to become non-empty
+   or non-full.  Waiting and waking turn interrupts off briefly,
+   but only when someone actually has to sleep. */
+struct ring
+  {
+    uint8_t *buf;               /* ELEM_CNT elements of ELEM_SIZE bytes. */
+    size_t elem_size;           /* Size of one element, in bytes. */
+    size_t elem_cnt;            /* Capacity; a power of 2. */
+    volatile size_t head;       /* Elements ever put; producer only. */
+    volatile size_t tail;       /* Elements ever got; consumer only. */
+    struct list not_empty;      /* Threads waiting for data. */
+    struct list not_full;       /* Threads waiting for room. */
+  };
+
+void ring_init (struct ring *, void *buf, size_t elem_size, size_t elem_cnt);
+size_t ring_cnt (const struct ring *);
+size_t ring_room (const struct ring *);
+bool ring_empty (const struct ring *);
+bool ring_full (const struct ring *);
+
+size_t ring_put (struct ring *, const void *, size_t cnt);
+size_t ring_get (struct ring *, void *, size_t cnt);
+
+void ring_wait_not_empty (struct ring *);
+void ring_wait_not_full (struct ring *);
+
+#endif /* devices/ring.h */
@@ -1,7 +1,7 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <string.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -51,9 +51,23 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
-
+/* Data to be transmitted.
+   This is a plain byte ring, large enough that a whole console
+   write can be queued at once and drained by serial_interrupt()
+   while the writer goes on.
+   HEAD and TAIL run freely; HEAD - TAIL is the number of bytes
+   queued. */
+#define TXQ_SIZE 4096
+static uint8_t txq[TXQ_SIZE];
+static size_t txq_head;                 /* New data is written here. */
+static size_t txq_tail;                 /* Old data is read here. */
+static struct lock txq_lock;            /* Only one thread may wait at once. */
+static struct thread *txq_waiter;       /* Thread waiting for transmission. */
+
+static bool txq_empty (void);
+static bool txq_full (void);
+static uint8_t txq_getc (void);
+static void txq_make_room (enum intr_level);
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
@@ -71,7 +85,9 @@ init_poll (void)
   outb (FCR_REG, 0);                    /* Disable FIFO. */
   set_serial (9600);                    /* 9.6 kbps, N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
+  lock_init (&txq_lock);
+  txq_head = txq_tail = 0;
+  txq_waiter = NULL;
   mode = POLL;
 } 
 
@@ -112,31 +128,91 @@ serial_putc (uint8_t byte)
     {
       /* Otherwise, queue a byte and update the interrupt enable
          register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
-        {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
-        }
+      if (txq_full ())
+        txq_make_room (old_level);
 
-      intq_putc (&txq, byte); 
+      txq[txq_head++ % TXQ_SIZE] = byte;
       write_ier ();
     }
   
   intr_set_level (old_level);
 }
 
+/* Sends the N bytes in BUFFER to the serial port.
+   In queued mode this only copies them into the transmit queue,
+   waiting for room only if the queue fills up, and leaves the
+   actual transmission to the serial interrupt. */
+void
+serial_putbuf (const uint8_t *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (mode != QUEUE)
+    {
+      if (mode == UNINIT)
+        init_poll ();
+      while (n-- > 0)
+        putc_poll (*buffer++);
+    }
+  else
+    {
+      while (n > 0)
+        {
+          if (txq_full ())
+            txq_make_room (old_level);
+
+          /* Copy as much as fits before the end of the ring. */
+          size_t ofs = txq_head % TXQ_SIZE;
+          size_t room = TXQ_SIZE - (txq_head - txq_tail);
+          size_t chunk = TXQ_SIZE - ofs < room ? TXQ_SIZE - ofs : room;
+          if (chunk > n)
+            chunk = n;
+          memcpy (txq + ofs, buffer, chunk);
+          txq_head += chunk;
+          buffer += chunk;
+          n -= chunk;
+          write_ier ();
+        }
+    }
+
+  intr_set_level (old_level);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (!txq_empty ())
+    putc_poll (txq_getc ());
+  intr_set_level (old_level);
+}
+
+/* Waits until the serial interrupt has transmitted everything in
+   the serial buffer.  Unlike serial_flush(), this sleeps instead
+   of polling, so it may only be called from a kernel thread.  If
+   interrupts are off, falls back to serial_flush(). */
+void
+serial_drain (void) 
+{
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  if (old_level == INTR_OFF || mode != QUEUE)
+    serial_flush ();
+  else
+    {
+      lock_acquire (&txq_lock);
+      while (!txq_empty ())
+        {
+          txq_waiter = thread_current ();
+          thread_block ();
+        }
+      lock_release (&txq_lock);
+    }
   intr_set_level (old_level);
 }
 
@@ -172,6 +248,60 @@ set_serial (int bps)
   outb (LCR_REG, LCR_N81);
 }
 
+/* Returns true if the transmit queue is empty. */
+static bool
+txq_empty (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return txq_head == txq_tail;
+}
+
+/* Returns true if the transmit queue is full. */
+static bool
+txq_full (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return txq_head - txq_tail == TXQ_SIZE;
+}
+
+/* Removes and returns the oldest byte in the transmit queue,
+   which must not be empty. */
+static uint8_t
+txq_getc (void) 
+{
+  ASSERT (!txq_empty ());
+  return txq[txq_tail++ % TXQ_SIZE];
+}
+
+/* Frees at least one byte in the full transmit queue.
+   OLD_LEVEL is the interrupt level of our caller. */
+static void
+txq_make_room (enum intr_level old_level) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (old_level == INTR_OFF || intr_context ()) 
+    {
+      /* Interrupts are off and the transmit queue is full.
+         If we wanted to wait for the queue to empty,
+         we'd have to reenable interrupts.
+         That's impolite, so we'll send a character via
+         polling instead. */
+      putc_poll (txq_getc ()); 
+    }
+  else
+    {
+      /* Let the serial interrupt make room. */
+      lock_acquire (&txq_lock);
+      while (txq_full ())
+        {
+          txq_waiter = thread_current ();
+          thread_block ();
+        }
+      lock_release (&txq_lock);
+    }
+}
+
 /* Update interrupt enable register. */
 static void
 write_ier (void) 
@@ -182,7 +312,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (!txq_empty ())
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -214,14 +344,40 @@ serial_interrupt (struct intr_frame *f UNUSED)
   inb (IIR_REG);
 
   /* As long as we have room to receive a byte, and the hardware
-     has a byte for us, receive a byte.  */
-  while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
-    input_putc (inb (RBR_REG));
+     has a byte for us, receive a byte.  Bytes are collected
+     locally and handed to the input buffer in one batch. */
+  uint8_t keys[16];
+  size_t room = input_room ();
+  size_t cnt = 0;
+  while (cnt < room && (inb (LSR_REG) & LSR_DR) != 0)
+    {
+      keys[cnt++] = inb (RBR_REG);
+      if (cnt == sizeof keys)
+        {
+          input_putbuf (keys, sizeof keys);
+          room -= sizeof keys;
+          cnt = 0;
+        }
+    }
+  if (cnt > 0)
+    input_putbuf (keys, cnt);
 
   /* As long as we have a byte to transmit, and the hardware is
      ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  bool sent = false;
+  while (!txq_empty () && (inb (LSR_REG) & LSR_THRE) != 0) 
+    {
+      outb (THR_REG, txq_getc ());
+      sent = true;
+    }
+
+  /* Wake up a writer waiting for room or for the queue to drain.
+     It rechecks its own condition. */
+  if (sent && txq_waiter != NULL) 
+    {
+      thread_unblock (txq_waiter);
+      txq_waiter = NULL;
+    }
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
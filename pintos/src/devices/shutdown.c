@@ -5,6 +5,8 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/memstat.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
@@ -130,6 +132,8 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  lock_print_stats ();
+  mem_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -7,6 +7,8 @@
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "userprog/gdt.h"
   
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -24,7 +26,26 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Tickless idle.  While the idle thread halts, channel 0 is
+   switched from its periodic mode to a single interrupt at the
+   next tick anything needs: the earliest sleeper's alarm, delayed
+   work coming due or, for -mlfqs, the next once-a-second update.  The 16-bit PIT counter
+   caps this at ONESHOT_MAX_TICKS ticks.  ONESHOT_TICKS is the
+   number of ticks the armed interrupt stands for, or 0 while the
+   timer is periodic. */
+#define TICK_CYCLES ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+#define ONESHOT_MAX_TICKS (UINT16_MAX / TICK_CYCLES)
+static int oneshot_ticks;
+static uint16_t oneshot_count;  /* PIT count the one-shot was armed with. */
+
+/* Sub-tick sleeps at least this many nanoseconds that do not end
+   within the current tick block until the next tick rather than
+   spin through it.  Anything shorter is a busy-wait, since a
+   context switch would cost more than it saves. */
+#define SLEEP_BLOCK_MIN_NS (1000 * 1000 * 1000 / TIMER_FREQ / 2)
+
 static intr_handler_func timer_interrupt;
+static void timer_advance (bool user);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -171,15 +192,104 @@ timer_print_stats (void)
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Called by the idle thread, with interrupts off, just before it
+   halts.  If no tick is needed for a while, replaces the periodic
+   interrupt by one at the first tick that is. */
+void
+timer_idle_enter (void)
+{
+  int n = ONESHOT_MAX_TICKS;
+  uint16_t remaining;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks != 0)
+    return;
+  if (!is_sleep_list_empty () && thread_slept_first ()->alarm_ticks - ticks < n)
+    n = thread_slept_first ()->alarm_ticks - ticks;
+  if (thread_mlfqs && TIMER_FREQ - ticks % TIMER_FREQ < n)
+    n = TIMER_FREQ - ticks % TIMER_FREQ;
+  if (workqueue_next_tick () - ticks < n)
+    n = workqueue_next_tick () - ticks;
+  if (n <= 1)
+    return;
+
+  /* Keep the tick phase: the first tick is whatever is left of
+     the current period, the rest are whole periods. */
+  remaining = pit_read_count (0);
+  if (remaining == 0 || remaining > TICK_CYCLES)
+    return;
+  oneshot_ticks = n;
+  oneshot_count = remaining + (n - 1) * TICK_CYCLES;
+  pit_oneshot (oneshot_count);
+}
+
+/* Called by the idle thread, with interrupts off, after an
+   interrupt other than the timer's woke it from a tickless halt.
+   Credits the ticks that have already passed and shortens the
+   one-shot to end at the next tick boundary, after which the
+   timer interrupt restores the periodic mode. */
+void
+timer_idle_exit (void)
+{
+  uint16_t remaining;
+  int passed;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks <= 1)
+    return;
+
+  /* In mode 0 the counter keeps running down past zero, so a
+     value above the armed count means the one-shot has already
+     fired and its interrupt is pending. */
+  remaining = pit_read_count (0);
+  if (remaining == 0 || remaining > oneshot_count)
+    return;
+
+  passed = oneshot_ticks - 1 - (remaining - 1) / TICK_CYCLES;
+  if (passed > 0)
+    {
+      ticks += passed;
+      thread_tick_idle (passed);
+    }
+  oneshot_ticks = 1;
+  oneshot_count = (remaining - 1) % TICK_CYCLES + 1;
+  pit_oneshot (oneshot_count);
+}
+
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
+{
+  bool user = args->cs == SEL_UCSEG;
+  int n = 1;
+
+  if (oneshot_ticks != 0)
+    {
+      /* End of a tickless halt: back to periodic interrupts,
+         which restart in phase from this tick boundary. */
+      n = oneshot_ticks;
+      oneshot_ticks = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+    }
+
+  while (n-- > 0)
+    timer_advance (user);
+  thread_preempt (); //addition for priority scheduling
+}
+
+/* Advances the clock by one tick, charging it to user mode if
+   USER, and wakes the threads and work whose time has come. */
+static void
+timer_advance (bool user)
 {
   ticks++;
-  thread_tick ();
+  thread_tick (user);
 
   while (!is_sleep_list_empty () && ticks >= thread_slept_first ()->alarm_ticks)
     thread_awake ();
+  workqueue_tick (ticks);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -235,6 +345,28 @@ real_time_sleep (int64_t num, int32_t denom)
          processes. */                
       timer_sleep (ticks); 
     }
+  else if (num * (1000 * 1000 * 1000 / denom) >= SLEEP_BLOCK_MIN_NS)
+    {
+      /* A sizable fraction of a tick.  If it ends before the next
+         tick, just spin.  Otherwise block until that tick, which
+         covers the rest of the current period, and spin for what
+         is left over.  A count read just as the counter reloads
+         only makes us sleep a tick longer, because the tick's
+         interrupt is taken before timer_sleep() reads TICKS. */
+      int64_t cycles = num * PIT_HZ / denom + 1;
+      int64_t left = pit_read_count (0);
+
+      if (left > TICK_CYCLES)
+        left = 0;
+      if (cycles <= left)
+        real_time_delay (num, denom);
+      else
+        {
+          timer_sleep (1);
+          real_time_delay ((cycles - left) * (1000 * 1000 * 1000) / PIT_HZ
+                           + 1, 1000 * 1000 * 1000);
+        }
+    }
   else 
     {
       /* Otherwise, use a busy-wait loop for more accurate
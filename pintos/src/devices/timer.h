@@ -24,6 +24,10 @@ void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
 void timer_ndelay (int64_t nanoseconds);
 
+/* Tickless idle. */
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+
 void timer_print_stats (void);
 
 #endif /* devices/timer.h */
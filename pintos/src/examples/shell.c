@@ -51,11 +51,24 @@ main (void)
 static void
 read_line (char line[], size_t size) 
 {
+  /* Keys read past the end of the previous line. */
+  static char keys[64];
+  static int key_cnt, key_pos;
+
   char *pos = line;
   for (;;)
     {
       char c;
-      read (STDIN_FILENO, &c, 1);
+
+      /* Take every key typed so far in one read. */
+      if (key_pos >= key_cnt) 
+        {
+          key_cnt = read (STDIN_FILENO, keys, sizeof keys);
+          key_pos = 0;
+          if (key_cnt <= 0)
+            continue;
+        }
+      c = keys[key_pos++];
 
       switch (c) 
         {
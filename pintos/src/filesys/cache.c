@@ -3,11 +3,13 @@
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "threads/thread.h"
+#include "threads/malloc.h"
+#include "threads/workqueue.h"
 #include "lib/string.h"
-#include "devices/timer.h"
 #include <stdbool.h>
 
 #define CACHE_SECTOR_CNT 64
+#define CACHE_FLUSH_TICKS 50	/* write-behind period */
 
 struct cte
 {
@@ -24,15 +26,16 @@ static struct lock cache_lock;
 static struct condition aheader_cond;
 static block_sector_t next_sector;
 static int victim_idx;
+static struct work flush_work;
 
 static int cache_alloc (block_sector_t);
-static void cache_flush_thread (void*);
+static void cache_flush_work (struct work*);
 static void cache_aheader_thread (void*) UNUSED;
 
 void
 cache_init (void)
 {
-  cache = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, BLOCK_SECTOR_SIZE * CACHE_SECTOR_CNT / PGSIZE);
+  cache = palloc_get_multiple (PAL_ASSERT | PAL_ZERO | PAL_TAG (MEM_CACHE), BLOCK_SECTOR_SIZE * CACHE_SECTOR_CNT / PGSIZE);
   for (int i = 0; i < CACHE_SECTOR_CNT; i++)
   {
     ct[i].in_use = false;
@@ -42,8 +45,8 @@ cache_init (void)
   cond_init (&aheader_cond);
   victim_idx = 0;
 
-  const char* name1 = "cache_flush_thread";
-  thread_create (name1, PRI_DEFAULT, cache_flush_thread, NULL);
+  work_init (&flush_work, cache_flush_work);
+  work_queue_delayed (&flush_work, CACHE_FLUSH_TICKS);
 
   //const char* name2 = "cache_aheader_thread";
   //thread_create (name2, PRI_DEFAULT, cache_aheader_thread, NULL);
@@ -125,6 +128,51 @@ cache_write_at (block_sector_t sector, const void* buffer, off_t size, off_t ofs
   }
 }
 
+/* (addition) copies the whole sector SRC into sector DST inside
+   the cache.  If both sectors are resident, the data moves from
+   one cache entry to the other; otherwise it goes through BOUNCE,
+   a sector-sized buffer supplied by the caller. */
+void
+cache_copy (block_sector_t dst, block_sector_t src, void* bounce)
+{
+  if (dst == src) return;
+
+  lock_acquire (&cache_lock);
+
+  int src_idx = -1;
+  int dst_idx = -1;
+  for (int i = 0; i < CACHE_SECTOR_CNT; i++)
+  {
+    if (!ct[i].in_use) continue;
+    if (ct[i].sector == src) src_idx = i;
+    else if (ct[i].sector == dst) dst_idx = i;
+  }
+
+  if (src_idx != -1 && dst_idx != -1)
+  {
+    /* entries are only reassigned under cache_lock, so locking them
+       here (in index order, like cache_alloc) pins both */
+    int first = src_idx < dst_idx ? src_idx : dst_idx;
+    int second = src_idx < dst_idx ? dst_idx : src_idx;
+    lock_acquire (&ct[first].lock);
+    lock_acquire (&ct[second].lock);
+    lock_release (&cache_lock);
+
+    memcpy (cache + dst_idx * BLOCK_SECTOR_SIZE, cache + src_idx * BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE);
+    ct[src_idx].accessed_cnt++;
+    ct[dst_idx].accessed_cnt++;
+    ct[dst_idx].dirty_cnt++;
+
+    lock_release (&ct[second].lock);
+    lock_release (&ct[first].lock);
+    return;
+  }
+  lock_release (&cache_lock);
+
+  cache_read (src, bounce);
+  cache_write (dst, bounce);
+}
+
 static int
 cache_alloc (block_sector_t sector)
 {
@@ -193,14 +241,12 @@ cache_flush (void)
   lock_release (&cache_lock);
 }
 
+/* periodic write-behind, run by a shared worker */
 static void
-cache_flush_thread (void* aux UNUSED)
+cache_flush_work (struct work* w)
 {
-  while (true)
-  {
-    timer_sleep (50);
-    cache_flush ();
-  }
+  cache_flush ();
+  work_queue_delayed (w, CACHE_FLUSH_TICKS);
 }
 
 static void
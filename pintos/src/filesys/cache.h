@@ -9,6 +9,7 @@ void cache_read (block_sector_t, void*);
 void cache_read_at (block_sector_t, void*, off_t, off_t);
 void cache_write (block_sector_t, const void*);
 void cache_write_at (block_sector_t, const void*, off_t, off_t);
+void cache_copy (block_sector_t, block_sector_t, void*);
 
 void cache_flush (void);
 
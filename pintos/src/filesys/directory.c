@@ -5,6 +5,7 @@
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/slab.h" //addition
 #include "threads/synch.h" //addition
 
 /* A directory. */
@@ -23,6 +24,15 @@ struct dir_entry
     bool in_use;                        /* In use or free? */
   };
 
+static struct kmem_cache *dir_cache; //addition
+
+/* (addition) Initializes the open directory cache. */
+void
+dir_init (void)
+{
+  dir_cache = kmem_cache_create ("dir", sizeof (struct dir), NULL);
+}
+
 /* Creates a directory with space for ENTRY_CNT entries in the
    given SECTOR.  Returns true if successful, false on failure. */
 bool
@@ -36,7 +46,7 @@ dir_create (block_sector_t sector, size_t entry_cnt)
 struct dir *
 dir_open (struct inode *inode) 
 {
-  struct dir *dir = calloc (1, sizeof *dir);
+  struct dir *dir = kmem_cache_zalloc (dir_cache); //addition
   if (inode != NULL && dir != NULL)
     {
       dir->inode = inode;
@@ -46,7 +56,7 @@ dir_open (struct inode *inode)
   else
     {
       inode_close (inode);
-      free (dir);
+      kmem_cache_free (dir_cache, dir);
       return NULL; 
     }
 }
@@ -74,7 +84,7 @@ dir_close (struct dir *dir)
   if (dir != NULL)
     {
       inode_close (dir->inode);
-      free (dir);
+      kmem_cache_free (dir_cache, dir);
     }
 }
 
@@ -232,10 +242,10 @@ bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
 {
   bool locked = false;
-  struct lock* lock = inode_dir_lock (dir->inode);
-  if (lock != NULL && !lock_held_by_current_thread (lock))
+  struct rwlock* lock = inode_dir_lock (dir->inode);
+  if (lock != NULL && !rwlock_write_held_by_current_thread (lock))
   {
-    lock_acquire (lock);
+    rwlock_acquire_read (lock);
     locked = true;
   }
 
@@ -247,11 +257,11 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
       if (e.in_use)
         {
           strlcpy (name, e.name, NAME_MAX + 1);
-          if (locked) lock_release (lock);
+          if (locked) rwlock_release_read (lock);
           return true;
         } 
     }
-  if (locked) lock_release (lock);
+  if (locked) rwlock_release_read (lock);
   return false;
 }
 
@@ -2,6 +2,7 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/slab.h" //addition
 
 /* An open file. */
 struct file 
@@ -11,13 +12,22 @@ struct file
     bool deny_write;            /* Has file_deny_write() been called? */
   };
 
+static struct kmem_cache *file_cache; //addition
+
+/* (addition) Initializes the open file cache. */
+void
+file_init (void)
+{
+  file_cache = kmem_cache_create ("file", sizeof (struct file), NULL);
+}
+
 /* Opens a file for the given INODE, of which it takes ownership,
    and returns the new file.  Returns a null pointer if an
    allocation fails or if INODE is null. */
 struct file *
 file_open (struct inode *inode) 
 {
-  struct file *file = calloc (1, sizeof *file);
+  struct file *file = kmem_cache_zalloc (file_cache); //addition
   if (inode != NULL && file != NULL)
     {
       file->inode = inode;
@@ -28,7 +38,7 @@ file_open (struct inode *inode)
   else
     {
       inode_close (inode);
-      free (file);
+      kmem_cache_free (file_cache, file);
       return NULL; 
     }
 }
@@ -49,7 +59,7 @@ file_close (struct file *file)
     {
       file_allow_write (file);
       inode_close (file->inode);
-      free (file); 
+      kmem_cache_free (file_cache, file); 
     }
 }
 
@@ -113,6 +123,24 @@ file_write_at (struct file *file, const void *buffer, off_t size,
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Copies SIZE bytes from SRC into DST inside the kernel,
+   starting at each file's current position.
+   Returns the number of bytes actually copied,
+   which may be less than SIZE if end of SRC is reached,
+   or -1 if both files share an inode and the ranges overlap.
+   Advances both files' positions by the number of bytes copied. */
+off_t
+file_copy (struct file *dst, struct file *src, off_t size)
+{
+  off_t bytes_copied = inode_copy_at (dst->inode, dst->pos,
+                                      src->inode, src->pos, size);
+  if (bytes_copied < 0)
+    return -1;
+  src->pos += bytes_copied;
+  dst->pos += bytes_copied;
+  return bytes_copied;
+}
+
 /* Prevents write operations on FILE's underlying inode
    until file_allow_write() is called or FILE is closed. */
 void
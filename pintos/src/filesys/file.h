@@ -6,6 +6,7 @@
 struct inode;
 
 /* Opening and closing files. */
+void file_init (void); //addition
 struct file *file_open (struct inode *);
 struct file *file_reopen (struct file *);
 void file_close (struct file *);
@@ -16,6 +17,7 @@ off_t file_read (struct file *, void *, off_t);
 off_t file_read_at (struct file *, void *, off_t size, off_t start);
 off_t file_write (struct file *, const void *, off_t);
 off_t file_write_at (struct file *, const void *, off_t size, off_t start);
+off_t file_copy (struct file *dst, struct file *src, off_t size);
 
 /* Preventing writes. */
 void file_deny_write (struct file *);
@@ -25,6 +25,8 @@ filesys_init (bool format)
     PANIC ("No file system device found, can't initialize file system.");
 
   inode_init ();
+  file_init (); //addition
+  dir_init (); //addition
   free_map_init ();
 
   if (format) 
@@ -63,8 +65,8 @@ filesys_create (const char *name, off_t initial_size)
 			free_map_allocate (1, &inode_sector) &&
 			inode_create (inode_sector, initial_size));
 
-  struct lock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
-  if (lock != NULL) lock_acquire (lock);
+  struct rwlock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
+  if (lock != NULL) rwlock_acquire_write (lock);
 
   success = success && dir_add (dir, parsed_name, inode_sector);
   if (success) dir_entry_clear_dir (dir, inode_sector);
@@ -77,9 +79,10 @@ filesys_create (const char *name, off_t initial_size)
 */
   if (!success && inode_sector != 0) 
     free_map_release (inode_sector, 1);
-  dir_close (dir);
 
-  if (lock != NULL) lock_release (lock);
+  /* the lock goes away with the directory's last close */
+  if (lock != NULL) rwlock_release_write (lock);
+  dir_close (dir);
 
   return success;
 }
@@ -110,28 +113,23 @@ filesys_open_with_is_dir (const char *name, bool* is_dir)
   {
     if (strlen (parsed_name) == 0) return dir;
 
-    struct lock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
-    if (lock != NULL) lock_acquire (lock);
+    struct rwlock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
+    if (lock != NULL) rwlock_acquire_read (lock);
 
     if (dir_lookup (dir, parsed_name, &inode))
       *is_dir = dir_entry_is_dir (dir, inode_get_inumber (inode));
+    /* the lock goes away with the directory's last close */
+    if (lock != NULL) rwlock_release_read (lock);
     dir_close (dir);
     if (inode == NULL || (!*is_dir && dummy))
     {
       inode_close (inode);
-      if (lock != NULL) lock_release (lock);
       return NULL;
     }
     else if (*is_dir)
-    {
-      if (lock != NULL) lock_release (lock);
       return dir_open (inode);
-    }
     else
-    {
-      if (lock != NULL) lock_release (lock);
       return file_open (inode);
-    }
   }
   inode_close (inode);
   dir_close (dir);
@@ -162,8 +160,8 @@ filesys_remove (const char *name)
 			dir != NULL &&
                         strlen (parsed_name) > 0;
 
-  struct lock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
-  if (lock != NULL) lock_acquire (lock);
+  struct rwlock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
+  if (lock != NULL) rwlock_acquire_write (lock);
 
   success = success && dir_lookup (dir, parsed_name, &inode);
 
@@ -192,7 +190,7 @@ filesys_remove (const char *name)
   if (success && !dir_remove (dir, parsed_name))
     PANIC ("filesys_remove FAIL");
 
-  if (lock != NULL) lock_release (lock);
+  if (lock != NULL) rwlock_release_write (lock);
   inode_close (inode);
   dir_close (dir);
 
@@ -7,6 +7,8 @@
 #include "filesys/free-map.h"
 #include "filesys/cache.h" //addition
 #include "threads/malloc.h"
+#include "threads/slab.h" //addition
+#include "threads/interrupt.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -102,7 +104,8 @@ struct inode
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
     struct lock grow_lock;		/* (addition) synch of file growth */
-    struct lock* dir_lockp;		/* (addition) synch of dir work */
+    struct rwlock* dir_lockp;		/* (addition) synch of dir work: lookups read, changes write */
+    unsigned write_gen;			/* (addition) bumped by every write */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -156,14 +159,42 @@ byte_to_sector (const struct inode *inode, off_t pos)
 }
 
 /* List of open inodes, so that opening a single inode twice
-   returns the same `struct inode'. */
+   returns the same `struct inode'.  (addition) Opening an
+   already-open inode only reads the list, so lookups share
+   open_inodes_lock and only insertion and removal take it for
+   writing; open_cnt itself is updated with interrupts off. */
 static struct list open_inodes;
+static struct rwlock open_inodes_lock;
+
+static struct inode* open_inodes_find (block_sector_t);
+
+/* (addition) Exact-size caches for in-memory inodes and their
+   directory locks. */
+static struct kmem_cache *inode_cache;
+static struct kmem_cache *dir_lock_cache;
+
+/* (addition) Told about every removed inode, so a cache that keeps
+   inodes open can close a removed one instead of keeping its
+   sectors allocated until it happens to look at it again. */
+static inode_remove_func *remove_hook;
+
+/* (addition) Constructs a directory lock.  Locks go back to the
+   cache released, so this runs once per object, not per open. */
+static void
+dir_lock_ctor (void *rw)
+{
+  rwlock_init_named (rw, "inode->dir_lockp");
+}
 
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  rwlock_init (&open_inodes_lock);
+  inode_cache = kmem_cache_create ("inode", sizeof (struct inode), NULL); //addition
+  dir_lock_cache = kmem_cache_create ("dir_lock", sizeof (struct rwlock),
+                                      dir_lock_ctor); //addition
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -693,46 +724,80 @@ inode_free_all (block_sector_t sector)
 struct inode *
 inode_open (block_sector_t sector)
 {
-  struct list_elem *e;
   struct inode *inode;
 
   /* Check whether this inode is already open. */
-  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
-       e = list_next (e)) 
+  rwlock_acquire_read (&open_inodes_lock);
+  inode = inode_reopen (open_inodes_find (sector));
+  rwlock_release_read (&open_inodes_lock);
+  if (inode != NULL)
+    return inode;
+
+  /* Check again now that nobody else can add it. */
+  rwlock_acquire_write (&open_inodes_lock);
+  inode = inode_reopen (open_inodes_find (sector));
+  if (inode != NULL)
     {
-      inode = list_entry (e, struct inode, elem);
-      if (inode->sector == sector) 
-        {
-          inode_reopen (inode);
-          return inode; 
-        }
+      rwlock_release_write (&open_inodes_lock);
+      return inode;
     }
 
   /* Allocate memory. */
-  inode = malloc (sizeof *inode);
+  inode = kmem_cache_alloc (inode_cache); //addition
   if (inode == NULL)
-    return NULL;
+    {
+      rwlock_release_write (&open_inodes_lock);
+      return NULL;
+    }
+  inode->dir_lockp = kmem_cache_alloc (dir_lock_cache); //addition
+  if (inode->dir_lockp == NULL)
+    {
+      kmem_cache_free (inode_cache, inode);
+      rwlock_release_write (&open_inodes_lock);
+      return NULL;
+    }
 
   /* Initialize. */
   list_push_front (&open_inodes, &inode->elem);
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
+  inode->write_gen = 0; //addition
   inode->removed = false;
   lock_init (&inode->grow_lock); //addition
-  inode->dir_lockp = malloc (sizeof (struct lock)); //addition
-  lock_init (inode->dir_lockp); //addition
   cache_read (inode->sector, &inode->data);
   //block_read (fs_device, inode->sector, &inode->data);
+  rwlock_release_write (&open_inodes_lock);
   return inode;
 }
 
+/* (addition) Returns the open inode for SECTOR, or a null
+   pointer.  open_inodes_lock must be held. */
+static struct inode*
+open_inodes_find (block_sector_t sector)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+       e = list_next (e)) 
+    {
+      struct inode* inode = list_entry (e, struct inode, elem);
+      if (inode->sector == sector) 
+        return inode;
+    }
+  return NULL;
+}
+
 /* Reopens and returns INODE. */
 struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
+  {
+    enum intr_level old_level = intr_disable (); //addition
     inode->open_cnt++;
+    intr_set_level (old_level);
+  }
   return inode;
 }
 
@@ -754,21 +819,26 @@ inode_close (struct inode *inode)
     return;
 
   /* Release resources if this was the last opener. */
-  if (--inode->open_cnt == 0)
+  rwlock_acquire_write (&open_inodes_lock);
+  enum intr_level old_level = intr_disable (); //addition
+  bool last = --inode->open_cnt == 0;
+  intr_set_level (old_level);
+  if (last)
+    list_remove (&inode->elem);
+  rwlock_release_write (&open_inodes_lock);
+
+  if (last)
     {
-      /* Remove from inode list and release lock. */
-      list_remove (&inode->elem);
- 
       /* Deallocate blocks if removed. */
       if (inode->removed) 
         {
-          free (inode->dir_lockp);
           inode_free_all (inode->sector);
           //free_map_release (inode->sector, 1);
           //free_map_release (inode->data.start, bytes_to_sectors (inode->data.length)); 
         }
 
-      free (inode); 
+      kmem_cache_free (dir_lock_cache, inode->dir_lockp); //addition
+      kmem_cache_free (inode_cache, inode); 
     }
 }
 
@@ -779,6 +849,16 @@ inode_remove (struct inode *inode)
 {
   ASSERT (inode != NULL);
   inode->removed = true;
+  if (remove_hook != NULL)
+    remove_hook (inode);
+}
+
+/* (addition) Makes inode_remove() call HOOK on each inode it
+   marks removed. */
+void
+inode_set_remove_hook (inode_remove_func *hook) 
+{
+  remove_hook = hook;
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -859,6 +939,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
   if (inode->deny_write_cnt)
     return 0;
+  inode->write_gen++;
 
   /* (addition) file growth */
   bool locked = false;
@@ -934,6 +1015,87 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   return bytes_written;
 }
 
+/* (addition) Copies SIZE bytes from SRC, starting at SRC_OFS, into
+   DST, starting at DST_OFS, without going through a user buffer.
+   DST grows as in inode_write_at().  Runs of full, aligned sectors
+   are copied cache entry to cache entry; the ragged ends go through
+   a sector-sized bounce buffer.
+   Returns the number of bytes actually copied, which may be less
+   than SIZE if end of SRC is reached or an error occurs, or -1 if
+   DST and SRC are the same inode and the two ranges overlap. */
+off_t
+inode_copy_at (struct inode *dst, off_t dst_ofs, struct inode *src,
+               off_t src_ofs, off_t size)
+{
+  off_t bytes_copied = 0;
+  uint8_t *bounce;
+
+  if (dst->deny_write_cnt)
+    return 0;
+
+  /* Never copy past the current end of SRC. */
+  lock_acquire (&src->grow_lock);
+  off_t src_left = inode_length (src) - src_ofs;
+  lock_release (&src->grow_lock);
+  if (size > src_left)
+    size = src_left;
+  if (size <= 0)
+    return 0;
+
+  /* Copying forward would read bytes it has already overwritten. */
+  if (dst == src && src_ofs < dst_ofs + size && dst_ofs < src_ofs + size)
+    return -1;
+
+  bounce = malloc (BLOCK_SECTOR_SIZE);
+  if (bounce == NULL)
+    return 0;
+  dst->write_gen++;
+
+  /* file growth, same as inode_write_at() */
+  lock_acquire (&dst->grow_lock);
+  if (dst_ofs + size > dst->data.length
+      && !inode_grow (dst, dst_ofs + size - dst->data.length))
+    PANIC ("FILE GROWTH FAIL: sector %d, length %d, offset %d, size %d", dst->sector, dst->data.length, dst_ofs, size);
+  lock_release (&dst->grow_lock);
+
+  while (size > 0)
+    {
+      lock_acquire (&src->grow_lock);
+      block_sector_t src_sector = byte_to_sector (src, src_ofs);
+      lock_release (&src->grow_lock);
+
+      lock_acquire (&dst->grow_lock);
+      block_sector_t dst_sector = byte_to_sector (dst, dst_ofs);
+      lock_release (&dst->grow_lock);
+
+      /* Bytes left in each sector, lesser of the two and SIZE. */
+      int src_sector_ofs = src_ofs % BLOCK_SECTOR_SIZE;
+      int dst_sector_ofs = dst_ofs % BLOCK_SECTOR_SIZE;
+      int src_sector_left = BLOCK_SECTOR_SIZE - src_sector_ofs;
+      int dst_sector_left = BLOCK_SECTOR_SIZE - dst_sector_ofs;
+      int chunk_size = src_sector_left < dst_sector_left ? src_sector_left : dst_sector_left;
+      if (size < chunk_size)
+        chunk_size = size;
+
+      if (src_sector_ofs == 0 && dst_sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
+        cache_copy (dst_sector, src_sector, bounce);
+      else
+        {
+          cache_read_at (src_sector, bounce, chunk_size, src_sector_ofs);
+          cache_write_at (dst_sector, bounce, chunk_size, dst_sector_ofs);
+        }
+
+      /* Advance. */
+      size -= chunk_size;
+      src_ofs += chunk_size;
+      dst_ofs += chunk_size;
+      bytes_copied += chunk_size;
+    }
+  free (bounce);
+
+  return bytes_copied;
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 void
@@ -995,8 +1157,24 @@ inode_is_used (struct inode* inode)
   return inode->open_cnt > 1;
 }
 
+/* (addition) whether INODE has been removed */
+bool
+inode_is_removed (const struct inode* inode)
+{
+  return inode->removed;
+}
+
+/* (addition) write generation of INODE.  It changes whenever
+   INODE's contents may have changed, so callers can tell whether
+   something they derived from the contents is still valid. */
+unsigned
+inode_write_gen (const struct inode* inode)
+{
+  return inode->write_gen;
+}
+
 /* (addition) dir_lock to use */
-struct lock*
+struct rwlock*
 inode_dir_lock (struct inode* inode)
 {
   return inode->dir_lockp;
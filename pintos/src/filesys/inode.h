@@ -7,6 +7,9 @@
 #include "threads/synch.h" //addition
 
 struct bitmap;
+struct inode;
+
+typedef void inode_remove_func (struct inode *);
 
 void inode_init (void);
 bool inode_create (block_sector_t, off_t);
@@ -17,6 +20,8 @@ void inode_close (struct inode *);
 void inode_remove (struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+off_t inode_copy_at (struct inode *dst, off_t dst_ofs, struct inode *src,
+                     off_t src_ofs, off_t size);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
@@ -25,6 +30,9 @@ off_t inode_length (const struct inode *);
 block_sector_t inode_get_parent (block_sector_t);
 bool inode_set_parent (block_sector_t, block_sector_t);
 bool inode_is_used (struct inode*);
-struct lock* inode_dir_lock (struct inode*);
+bool inode_is_removed (const struct inode*);
+unsigned inode_write_gen (const struct inode*);
+struct rwlock* inode_dir_lock (struct inode*);
+void inode_set_remove_hook (inode_remove_func *);
 
 #endif /* filesys/inode.h */
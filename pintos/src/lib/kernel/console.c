@@ -148,16 +148,31 @@ puts (const char *s)
   return 0;
 }
 
-/* Writes the N characters in BUFFER to the console. */
+/* Writes the N characters in BUFFER to the console.
+   The characters are queued for the serial port in one piece, so
+   this returns as soon as they fit in the transmit queue rather
+   than when they have been sent. */
 void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  write_cnt += n;
+  serial_putbuf ((const uint8_t *) buffer, n);
+  vga_putbuf (buffer, n);
   release_console ();
 }
 
+/* Waits until everything written to the console so far has left
+   the serial port. */
+void
+console_flush (void) 
+{
+  if (intr_context () || !use_console_lock)
+    serial_flush ();
+  else
+    serial_drain ();
+}
+
 /* Writes C to the vga display and serial port. */
 int
 putchar (int c) 
@@ -4,5 +4,6 @@
 void console_init (void);
 void console_panic (void);
 void console_print_stats (void);
+void console_flush (void);
 
 #endif /* lib/kernel/console.h */
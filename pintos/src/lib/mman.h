@@ -0,0 +1,9 @@
+#ifndef __LIB_MMAN_H
+#define __LIB_MMAN_H
+
+/* Flags for the mmap_ex system call. */
+#define MAP_PRIVATE   0x0       /* Pages belong to this process alone. */
+#define MAP_SHARED    0x1       /* Pages are shared by all mappers of the object. */
+#define MAP_ANONYMOUS 0x2       /* Zero-filled pages, not backed by a file. */
+
+#endif /* lib/mman.h */
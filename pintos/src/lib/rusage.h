@@ -0,0 +1,20 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* CPU usage, as reported by the getrusage system call.  Times are
+   in timer ticks (TIMER_FREQ per second). */
+struct rusage
+  {
+    int64_t utime;              /* Ticks spent in user mode. */
+    int64_t stime;              /* Ticks spent in kernel mode. */
+    unsigned nvcsw;             /* Voluntary context switches. */
+    unsigned nivcsw;            /* Involuntary context switches. */
+  };
+
+/* Values for getrusage()'s WHO argument. */
+#define RUSAGE_SELF 0           /* The calling process. */
+#define RUSAGE_CHILDREN (-1)    /* Children that have been waited for. */
+
+#endif /* lib/rusage.h */
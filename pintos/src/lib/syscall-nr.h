@@ -28,7 +28,16 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_COPY_FILE_RANGE,        /* Copies between files in the kernel. */
+    SYS_SETNONBLOCK,            /* Turns non-blocking reads on or off. */
+    SYS_POLL,                   /* Returns bytes readable without waiting. */
+    SYS_SPAWN,                  /* Starts a process without waiting for it to load. */
+    SYS_GETRUSAGE,              /* Reports CPU usage. */
+    SYS_SBRK,                   /* Moves the end of the heap. */
+    SYS_MMAP_EX                 /* Maps anonymous or shared memory. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,250 @@
+#include <stdlib.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+
+/* A simple user-level malloc().
+
+   Memory comes from the kernel through sbrk(), which moves the
+   end of the process's heap.  Every block starts with a header
+   that records its size.
+
+   Requests of up to MAX_SMALL bytes are rounded up to a power of
+   2 and served from the free list of that size class.  An empty
+   free list is refilled by carving a block off the current chunk,
+   a CHUNK_SIZE piece of heap obtained from sbrk() in one call.
+   Freed small blocks go back on their class's list and are never
+   returned to the kernel.
+
+   Bigger requests are rounded up to whole pages.  Freed big
+   blocks are kept on a list and reused first-fit, except that a
+   big block at the very end of the heap is handed back to the
+   kernel with a negative sbrk(). */
+
+/* Smallest and largest size class, including the header. */
+#define MIN_SMALL 16
+#define MAX_SMALL 2048
+
+/* Number of size classes. */
+#define CLASS_CNT 8
+
+/* Heap obtained at a time for small blocks. */
+#define CHUNK_SIZE (16 * 1024)
+
+/* Page size, for rounding big blocks. */
+#define PAGE_SIZE 4096
+
+/* Magic number for detecting corrupt or foreign blocks. */
+#define BLOCK_MAGIC 0x6d616c63
+
+/* Block header.  8 bytes, so user data stays 8-byte aligned. */
+struct header
+  {
+    size_t size;                /* Block size, header included. */
+    unsigned magic;             /* Always BLOCK_MAGIC. */
+  };
+
+/* A free block's body links it into a free list. */
+struct free_block
+  {
+    struct header header;
+    struct free_block *next;
+  };
+
+static struct free_block *free_lists[CLASS_CNT]; /* Small blocks. */
+static struct free_block *big_list;              /* Big blocks. */
+static uint8_t *chunk_ptr, *chunk_end;           /* Uncarved chunk. */
+
+/* Returns the size class for a block of SIZE bytes, header
+   included. */
+static int
+size_class (size_t size)
+{
+  int class = 0;
+  size_t class_size = MIN_SMALL;
+
+  while (class_size < size)
+    {
+      class_size *= 2;
+      class++;
+    }
+  return class;
+}
+
+/* Returns a fresh small block of CLASS_SIZE bytes carved from
+   the current chunk, getting a new chunk if needed, or a null
+   pointer if the heap cannot grow. */
+static struct header *
+carve (size_t class_size)
+{
+  struct header *h;
+
+  if ((size_t) (chunk_end - chunk_ptr) < class_size)
+    {
+      uint8_t *chunk = sbrk (CHUNK_SIZE);
+      if (chunk == (uint8_t *) -1)
+        return NULL;
+
+      /* Extend the current chunk if the heap did not move in
+         between, otherwise abandon its tail. */
+      if (chunk != chunk_end)
+        chunk_ptr = chunk;
+      chunk_end = chunk + CHUNK_SIZE;
+    }
+
+  h = (struct header *) chunk_ptr;
+  chunk_ptr += class_size;
+  h->size = class_size;
+  return h;
+}
+
+/* Returns a big block of at least SIZE bytes, header included,
+   or a null pointer if the heap cannot grow. */
+static struct header *
+big_get (size_t size)
+{
+  struct free_block **bp;
+  struct header *h;
+
+  size = ROUND_UP (size, PAGE_SIZE);
+  for (bp = &big_list; *bp != NULL; bp = &(*bp)->next)
+    if ((*bp)->header.size >= size)
+      {
+        h = &(*bp)->header;
+        *bp = (*bp)->next;
+        return h;
+      }
+
+  h = sbrk (size);
+  if (h == (struct header *) -1)
+    return NULL;
+  h->size = size;
+  return h;
+}
+
+/* Frees big block H. */
+static void
+big_put (struct header *h)
+{
+  struct free_block *b = (struct free_block *) h;
+
+  if ((uint8_t *) h + h->size == sbrk (0) && sbrk (-(intptr_t) h->size) == h)
+    return;
+  b->next = big_list;
+  big_list = b;
+}
+
+/* Obtains and returns a new block of at least SIZE bytes.
+   Returns a null pointer if memory is not available. */
+void *
+malloc (size_t size)
+{
+  struct header *h;
+
+  if (size == 0 || size > SIZE_MAX - PAGE_SIZE - sizeof *h)
+    return NULL;
+
+  size += sizeof *h;
+  if (size <= MAX_SMALL)
+    {
+      int class = size_class (size);
+      if (free_lists[class] != NULL)
+        {
+          h = &free_lists[class]->header;
+          free_lists[class] = free_lists[class]->next;
+        }
+      else
+        h = carve ((size_t) MIN_SMALL << class);
+    }
+  else
+    h = big_get (size);
+
+  if (h == NULL)
+    return NULL;
+  h->magic = BLOCK_MAGIC;
+  return h + 1;
+}
+
+/* Allocates and return A times B bytes initialized to zeroes.
+   Returns a null pointer if memory is not available. */
+void *
+calloc (size_t a, size_t b)
+{
+  void *p;
+  size_t size;
+
+  /* Calculate block size and make sure it fits in size_t. */
+  size = a * b;
+  if (b != 0 && size / b != a)
+    return NULL;
+
+  /* Allocate and zero memory. */
+  p = malloc (size);
+  if (p != NULL)
+    memset (p, 0, size);
+
+  return p;
+}
+
+/* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly
+   moving it in the process.
+   If successful, returns the new block; on failure, returns a
+   null pointer.
+   A call with null OLD_BLOCK is equivalent to malloc(NEW_SIZE).
+   A call with zero NEW_SIZE is equivalent to free(OLD_BLOCK). */
+void *
+realloc (void *old_block, size_t new_size)
+{
+  struct header *h;
+  void *new_block;
+  size_t old_size;
+
+  if (new_size == 0)
+    {
+      free (old_block);
+      return NULL;
+    }
+  if (old_block == NULL)
+    return malloc (new_size);
+
+  h = (struct header *) old_block - 1;
+  ASSERT (h->magic == BLOCK_MAGIC);
+  old_size = h->size - sizeof *h;
+  if (new_size <= old_size)
+    return old_block;
+
+  new_block = malloc (new_size);
+  if (new_block != NULL)
+    {
+      memcpy (new_block, old_block, old_size);
+      free (old_block);
+    }
+  return new_block;
+}
+
+/* Frees block P, which must have been previously allocated with
+   malloc(), calloc(), or realloc(). */
+void
+free (void *p)
+{
+  struct header *h;
+
+  if (p == NULL)
+    return;
+
+  h = (struct header *) p - 1;
+  ASSERT (h->magic == BLOCK_MAGIC);
+  h->magic = 0;
+
+  if (h->size <= MAX_SMALL)
+    {
+      struct free_block *b = (struct free_block *) h;
+      int class = size_class (h->size);
+      b->next = free_lists[class];
+      free_lists[class] = b;
+    }
+  else
+    big_put (h);
+}
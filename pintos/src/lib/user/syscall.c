@@ -61,6 +61,25 @@
           retval;                                               \
         })
 
+/* Invokes syscall NUMBER, passing arguments ARG0, ARG1, ARG2,
+   and ARG3, and returns the return value as an `int'. */
+#define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3)                \
+        ({                                                      \
+          int retval;                                           \
+          asm volatile                                          \
+            ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; "    \
+             "pushl %[arg0]; pushl %[number]; int $0x30; "      \
+             "addl $20, %%esp"                                  \
+               : "=a" (retval)                                  \
+               : [number] "i" (NUMBER),                         \
+                 [arg0] "r" (ARG0),                             \
+                 [arg1] "r" (ARG1),                             \
+                 [arg2] "r" (ARG2),                             \
+                 [arg3] "r" (ARG3)                              \
+               : "memory");                                     \
+          retval;                                               \
+        })
+
 void
 halt (void) 
 {
@@ -182,3 +201,45 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+int
+copy_file_range (int fd_in, int fd_out, unsigned length)
+{
+  return syscall3 (SYS_COPY_FILE_RANGE, fd_in, fd_out, length);
+}
+
+bool
+setnonblock (int fd, bool nonblock)
+{
+  return syscall2 (SYS_SETNONBLOCK, fd, (int) nonblock);
+}
+
+int
+poll (int fd)
+{
+  return syscall1 (SYS_POLL, fd);
+}
+
+pid_t
+spawn (const char *file)
+{
+  return (pid_t) syscall1 (SYS_SPAWN, file);
+}
+
+int
+getrusage (int who, struct rusage *usage)
+{
+  return syscall2 (SYS_GETRUSAGE, who, usage);
+}
+
+void *
+sbrk (intptr_t increment)
+{
+  return (void *) syscall1 (SYS_SBRK, increment);
+}
+
+mapid_t
+mmap_ex (int fd, void *addr, size_t length, int flags)
+{
+  return syscall4 (SYS_MMAP_EX, fd, addr, length, flags);
+}
@@ -2,7 +2,10 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <debug.h>
+#include <rusage.h>
+#include <mman.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +48,13 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int copy_file_range (int fd_in, int fd_out, unsigned length);
+bool setnonblock (int fd, bool nonblock);
+int poll (int fd);
+pid_t spawn (const char *file);
+int getrusage (int who, struct rusage *usage);
+void *sbrk (intptr_t increment);
+mapid_t mmap_ex (int fd, void *addr, size_t length, int flags);
+
 #endif /* lib/user/syscall.h */
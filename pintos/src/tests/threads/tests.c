@@ -38,6 +38,10 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"work-delayed", test_work_delayed},
+    {"work-cancel", test_work_cancel},
+    {"work-cancel-sync", test_work_cancel_sync},
+    {"work-requeue", test_work_requeue},
   };
 
 static const char *test_name;
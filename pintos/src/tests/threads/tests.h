@@ -32,6 +32,10 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_work_delayed;
+extern test_func test_work_cancel;
+extern test_func test_work_cancel_sync;
+extern test_func test_work_requeue;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
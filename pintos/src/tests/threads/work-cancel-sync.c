@@ -0,0 +1,43 @@
+/* Calls work_cancel_sync() on a work item whose function is
+   running and sleeping, and checks that it returns only after
+   the function has finished. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+static bool finished;
+static struct semaphore started;
+
+static void slow (struct work *);
+
+void
+test_work_cancel_sync (void) 
+{
+  struct work w;
+  bool cancelled;
+
+  sema_init (&started, 0);
+  work_init (&w, slow);
+
+  work_queue (&w);
+  sema_down (&started);
+  cancelled = work_cancel_sync (&w);
+
+  if (!finished)
+    fail ("work_cancel_sync returned while the work was running");
+  msg ("work_cancel_sync (running): %s, after the work finished",
+       cancelled ? "true" : "false");
+}
+
+/* Sleeps for a while before marking itself finished. */
+static void
+slow (struct work *w UNUSED) 
+{
+  sema_up (&started);
+  timer_sleep (20);
+  finished = true;
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(work-cancel-sync) begin
+(work-cancel-sync) work_cancel_sync (running): false, after the work finished
+(work-cancel-sync) end
+EOF
+pass;
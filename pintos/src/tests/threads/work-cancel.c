@@ -0,0 +1,73 @@
+/* Cancels a delayed work item and, while every worker is kept
+   busy, a pending one, and checks that neither ever runs. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+/* Enough blockers to occupy every worker thread. */
+#define BLOCKER_CNT 2
+
+static int runs;
+static struct semaphore started, gate, finished;
+
+static void count_run (struct work *);
+static void blocker (struct work *);
+
+void
+test_work_cancel (void) 
+{
+  struct work blockers[BLOCKER_CNT];
+  struct work w;
+  int i;
+
+  sema_init (&started, 0);
+  sema_init (&gate, 0);
+  sema_init (&finished, 0);
+  work_init (&w, count_run);
+
+  msg ("work_cancel (idle): %s", work_cancel (&w) ? "true" : "false");
+
+  work_queue_delayed (&w, 5);
+  msg ("work_cancel (delayed): %s", work_cancel (&w) ? "true" : "false");
+
+  /* Tie up the workers so that W stays pending. */
+  for (i = 0; i < BLOCKER_CNT; i++)
+    {
+      work_init (&blockers[i], blocker);
+      work_queue (&blockers[i]);
+    }
+  for (i = 0; i < BLOCKER_CNT; i++)
+    sema_down (&started);
+
+  work_queue (&w);
+  msg ("work_cancel (pending): %s", work_cancel (&w) ? "true" : "false");
+
+  for (i = 0; i < BLOCKER_CNT; i++)
+    sema_up (&gate);
+  for (i = 0; i < BLOCKER_CNT; i++)
+    sema_down (&finished);
+
+  /* Give a stray run time to happen. */
+  timer_sleep (20);
+  msg ("cancelled work ran %d times", runs);
+}
+
+/* Counts its runs. */
+static void
+count_run (struct work *w UNUSED) 
+{
+  runs++;
+}
+
+/* Holds its worker until the test opens GATE. */
+static void
+blocker (struct work *w UNUSED) 
+{
+  sema_up (&started);
+  sema_down (&gate);
+  sema_up (&finished);
+}
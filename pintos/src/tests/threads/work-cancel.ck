@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(work-cancel) begin
+(work-cancel) work_cancel (idle): false
+(work-cancel) work_cancel (delayed): true
+(work-cancel) work_cancel (pending): true
+(work-cancel) cancelled work ran 0 times
+(work-cancel) end
+EOF
+pass;
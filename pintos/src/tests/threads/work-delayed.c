@@ -0,0 +1,48 @@
+/* Queues a work item 10 ticks from now and checks that it does
+   not run before that tick, and that queueing it again while it
+   is still delayed has no effect. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+static int64_t ran_at;
+static struct semaphore done;
+
+static void record_tick (struct work *);
+
+void
+test_work_delayed (void) 
+{
+  struct work w;
+  int64_t start;
+
+  sema_init (&done, 0);
+  work_init (&w, record_tick);
+
+  /* Make sure we're at the beginning of a timer tick. */
+  timer_sleep (1);
+
+  start = timer_ticks ();
+  msg ("work_queue_delayed (10): %s",
+       work_queue_delayed (&w, 10) ? "true" : "false");
+  msg ("work_queue_delayed (1) again: %s",
+       work_queue_delayed (&w, 1) ? "true" : "false");
+  sema_down (&done);
+
+  if (ran_at - start < 10)
+    fail ("delayed work ran after %"PRId64" ticks", ran_at - start);
+  msg ("delayed work ran no earlier than 10 ticks later");
+}
+
+/* Records the tick it runs at. */
+static void
+record_tick (struct work *w UNUSED) 
+{
+  ran_at = timer_ticks ();
+  sema_up (&done);
+}
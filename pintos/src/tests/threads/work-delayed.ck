@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(work-delayed) begin
+(work-delayed) work_queue_delayed (10): true
+(work-delayed) work_queue_delayed (1) again: false
+(work-delayed) delayed work ran no earlier than 10 ticks later
+(work-delayed) end
+EOF
+pass;
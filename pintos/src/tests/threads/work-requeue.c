@@ -0,0 +1,45 @@
+/* Runs a work item that requeues itself with a delay until it
+   has run 3 times. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+static int runs;
+static struct semaphore done;
+
+static void periodic (struct work *);
+
+void
+test_work_requeue (void) 
+{
+  struct work w;
+
+  sema_init (&done, 0);
+  work_init (&w, periodic);
+
+  work_queue (&w);
+  sema_down (&done);
+
+  /* A fourth run would be a requeue we did not ask for. */
+  timer_sleep (20);
+  msg ("work ran %d times", runs);
+}
+
+/* Requeues itself 2 ticks out until its third run. */
+static void
+periodic (struct work *w) 
+{
+  runs++;
+  msg ("run %d", runs);
+  if (runs < 3)
+    {
+      if (!work_queue_delayed (w, 2))
+        fail ("work_queue_delayed from its own function failed");
+    }
+  else
+    sema_up (&done);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(work-requeue) begin
+(work-requeue) run 1
+(work-requeue) run 2
+(work-requeue) run 3
+(work-requeue) work ran 3 times
+(work-requeue) end
+EOF
+pass;
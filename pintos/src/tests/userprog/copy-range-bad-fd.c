@@ -0,0 +1,22 @@
+/* Passes copy_file_range fds that are not open, which must fail
+   with -1, then fds that are not valid at all, which must either
+   fail silently or terminate the process with exit code -1. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  msg ("copy to unopened fd: %d", copy_file_range (handle, 15, 10));
+  msg ("copy from unopened fd: %d", copy_file_range (15, handle, 10));
+  copy_file_range (handle, 0x20101234, 10);
+  copy_file_range (INT_MIN, handle, 10);
+  copy_file_range (handle, 1, 10);
+  copy_file_range (0, handle, 10);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(copy-range-bad-fd) begin
+(copy-range-bad-fd) open "sample.txt"
+(copy-range-bad-fd) copy to unopened fd: -1
+(copy-range-bad-fd) copy from unopened fd: -1
+(copy-range-bad-fd) end
+copy-range-bad-fd: exit(0)
+EOF
+(copy-range-bad-fd) begin
+(copy-range-bad-fd) open "sample.txt"
+(copy-range-bad-fd) copy to unopened fd: -1
+(copy-range-bad-fd) copy from unopened fd: -1
+copy-range-bad-fd: exit(-1)
+EOF
+pass;
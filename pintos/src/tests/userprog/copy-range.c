@@ -0,0 +1,59 @@
+/* Copies between two files with copy_file_range: a ragged range,
+   whole sectors, a range that runs past the end of the source,
+   and an overlapping range of one file, which must be refused.
+   Then verifies both files. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char src[3 * 512 + 100];
+static char dst[4 * 512];
+
+void
+test_main (void) 
+{
+  int in, in2, out;
+  size_t i;
+
+  for (i = 0; i < sizeof src; i++)
+    src[i] = i * 7 + 1;
+
+  CHECK (create ("src", sizeof src), "create \"src\"");
+  CHECK (create ("dst", sizeof dst), "create \"dst\"");
+  CHECK ((in = open ("src")) > 1, "open \"src\"");
+  CHECK ((out = open ("dst")) > 1, "open \"dst\"");
+  CHECK (write (in, src, sizeof src) == (int) sizeof src, "write \"src\"");
+
+  seek (in, 100);
+  seek (out, 30);
+  CHECK (copy_file_range (in, out, 700) == 700,
+         "copy 700 bytes from offset 100 to offset 30");
+  memcpy (dst + 30, src + 100, 700);
+
+  seek (in, 512);
+  seek (out, 1024);
+  CHECK (copy_file_range (in, out, 1024) == 1024,
+         "copy 1024 bytes from offset 512 to offset 1024");
+  memcpy (dst + 1024, src + 512, 1024);
+
+  seek (in, 3 * 512);
+  seek (out, 0);
+  CHECK (copy_file_range (in, out, 512) == 100,
+         "copy 512 bytes from offset 1536, 100 left");
+  memcpy (dst, src + 3 * 512, 100);
+  CHECK (copy_file_range (in, out, 512) == 0, "copy at end of \"src\"");
+
+  CHECK ((in2 = open ("src")) > 1, "open \"src\" again");
+  seek (in, 0);
+  seek (in2, 10);
+  CHECK (copy_file_range (in, in2, 100) == -1,
+         "copy \"src\" onto itself, overlapping");
+
+  close (in2);
+  close (out);
+  close (in);
+  check_file ("src", src, sizeof src);
+  check_file ("dst", dst, sizeof dst);
+}
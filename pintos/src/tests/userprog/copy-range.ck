@@ -0,0 +1,27 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(copy-range) begin
+(copy-range) create "src"
+(copy-range) create "dst"
+(copy-range) open "src"
+(copy-range) open "dst"
+(copy-range) write "src"
+(copy-range) copy 700 bytes from offset 100 to offset 30
+(copy-range) copy 1024 bytes from offset 512 to offset 1024
+(copy-range) copy 512 bytes from offset 1536, 100 left
+(copy-range) copy at end of "src"
+(copy-range) open "src" again
+(copy-range) copy "src" onto itself, overlapping
+(copy-range) open "src" for verification
+(copy-range) verified contents of "src"
+(copy-range) close "src"
+(copy-range) open "dst" for verification
+(copy-range) verified contents of "dst"
+(copy-range) close "dst"
+(copy-range) end
+copy-range: exit(0)
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Copies child-simple to a new file and executes it, overwrites
+   that file in place with child-args and executes it again, then
+   removes it.  Each exec must run what is in the file now, not a
+   layout parsed earlier from the old contents, and executing the
+   removed file must fail.  A new file of the same name must then
+   run its own contents. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Copies the contents of FROM over the start of TO, which must
+   already exist. */
+static void
+copy_over (const char *from, const char *to) 
+{
+  char buf[512];
+  int src, dst;
+  int n;
+
+  CHECK ((src = open (from)) > 1, "open \"%s\"", from);
+  CHECK ((dst = open (to)) > 1, "open \"%s\"", to);
+  while ((n = read (src, buf, sizeof buf)) > 0)
+    if (write (dst, buf, n) != n)
+      fail ("write to \"%s\" failed", to);
+  close (src);
+  close (dst);
+}
+
+void
+test_main (void) 
+{
+  CHECK (create ("exec-copy", 0), "create \"exec-copy\"");
+  copy_over ("child-simple", "exec-copy");
+  msg ("wait(exec()) = %d", wait (exec ("exec-copy")));
+
+  copy_over ("child-args", "exec-copy");
+  msg ("wait(exec()) = %d", wait (exec ("exec-copy")));
+
+  CHECK (remove ("exec-copy"), "remove \"exec-copy\"");
+  msg ("exec(\"exec-copy\"): %d", exec ("exec-copy"));
+
+  CHECK (create ("exec-copy", 0), "create \"exec-copy\" again");
+  copy_over ("child-simple", "exec-copy");
+  msg ("wait(exec()) = %d", wait (exec ("exec-copy")));
+}
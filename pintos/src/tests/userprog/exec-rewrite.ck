@@ -0,0 +1,34 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-rewrite) begin
+(exec-rewrite) create "exec-copy"
+(exec-rewrite) open "child-simple"
+(exec-rewrite) open "exec-copy"
+(child-simple) run
+exec-copy: exit(81)
+(exec-rewrite) wait(exec()) = 81
+(exec-rewrite) open "child-args"
+(exec-rewrite) open "exec-copy"
+(args) begin
+(args) argc = 1
+(args) argv[0] = 'exec-copy'
+(args) argv[1] = null
+(args) end
+exec-copy: exit(0)
+(exec-rewrite) wait(exec()) = 0
+(exec-rewrite) remove "exec-copy"
+load: exec-copy: open failed
+(exec-rewrite) exec("exec-copy"): -1
+(exec-rewrite) create "exec-copy" again
+(exec-rewrite) open "child-simple"
+(exec-rewrite) open "exec-copy"
+(child-simple) run
+exec-copy: exit(81)
+(exec-rewrite) wait(exec()) = 81
+(exec-rewrite) end
+exec-rewrite: exit(0)
+EOF
+pass;
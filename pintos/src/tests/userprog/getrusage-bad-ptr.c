@@ -0,0 +1,13 @@
+/* Passes an invalid pointer to the getrusage system call.
+   The process must be terminated with -1 exit code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  getrusage (RUSAGE_SELF, (struct rusage *) 0xc0100000);
+  fail ("should not have survived getrusage()");
+}
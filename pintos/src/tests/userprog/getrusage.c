@@ -0,0 +1,48 @@
+/* Checks getrusage for the calling process and for its waited-for
+   children, and that an unknown WHO is refused. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage before, after, children;
+  volatile int i;
+  int tries;
+
+  /* Spin until at least one tick has been charged to user mode. */
+  CHECK (getrusage (RUSAGE_SELF, &before) == 0, "getrusage (RUSAGE_SELF)");
+  for (tries = 0; tries < 1000; tries++)
+    {
+      for (i = 0; i < 100000; i++)
+        continue;
+      if (getrusage (RUSAGE_SELF, &after) != 0)
+        fail ("getrusage (RUSAGE_SELF) failed");
+      if (after.utime < before.utime || after.stime < before.stime
+          || after.nvcsw < before.nvcsw || after.nivcsw < before.nivcsw)
+        fail ("usage went backward");
+      if (after.utime > before.utime)
+        break;
+    }
+  if (tries == 1000)
+    fail ("user time did not grow while spinning");
+  msg ("user time grew");
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  if (children.utime != 0 || children.stime != 0
+      || children.nvcsw != 0 || children.nivcsw != 0)
+    fail ("children used time before any child ran");
+
+  msg ("wait(exec()) = %d", wait (exec ("child-simple")));
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN) after wait");
+  /* child-simple blocks at least while it loads from disk and
+     when it flushes the console at exit. */
+  if (children.nvcsw + children.nivcsw == 0)
+    fail ("waited-for child's context switches are missing");
+
+  msg ("getrusage (5): %d", getrusage (5, &children));
+}
@@ -0,0 +1,24 @@
+/* Passes poll and setnonblock fds that are not readable files.
+   poll must return -1 and setnonblock, which only applies to the
+   console, must return false. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  msg ("poll (1): %d", poll (1));
+  msg ("poll (2): %d", poll (2));
+  msg ("poll (15): %d", poll (15));
+  msg ("poll (0x20101234): %d", poll (0x20101234));
+  msg ("poll (INT_MIN): %d", poll (INT_MIN));
+  msg ("setnonblock (1): %d", setnonblock (1, true));
+  msg ("setnonblock (file): %d", setnonblock (handle, true));
+  msg ("setnonblock (INT_MAX): %d", setnonblock (INT_MAX, true));
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-bad-fd) begin
+(poll-bad-fd) open "sample.txt"
+(poll-bad-fd) poll (1): -1
+(poll-bad-fd) poll (2): -1
+(poll-bad-fd) poll (15): -1
+(poll-bad-fd) poll (0x20101234): -1
+(poll-bad-fd) poll (INT_MIN): -1
+(poll-bad-fd) setnonblock (1): 0
+(poll-bad-fd) setnonblock (file): 0
+(poll-bad-fd) setnonblock (INT_MAX): 0
+(poll-bad-fd) end
+poll-bad-fd: exit(0)
+EOF
+pass;
@@ -0,0 +1,24 @@
+/* Checks that poll on a file reports the bytes left between the
+   file position and the end of the file. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[100];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  msg ("poll at start: %d", poll (handle));
+  CHECK (read (handle, buf, sizeof buf) == (int) sizeof buf,
+         "read %zu bytes", sizeof buf);
+  msg ("poll after read: %d", poll (handle));
+  seek (handle, sizeof sample - 1);
+  msg ("poll at end: %d", poll (handle));
+  seek (handle, 1000);
+  msg ("poll past end: %d", poll (handle));
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-file) begin
+(poll-file) open "sample.txt"
+(poll-file) poll at start: 239
+(poll-file) read 100 bytes
+(poll-file) poll after read: 139
+(poll-file) poll at end: 0
+(poll-file) poll past end: 0
+(poll-file) end
+poll-file: exit(0)
+EOF
+pass;
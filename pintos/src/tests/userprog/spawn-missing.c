@@ -0,0 +1,21 @@
+/* Tries to spawn a nonexistent program and a file that is not an
+   executable.  spawn must return -1 for both, and waiting on the
+   result must return -1 too. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t pid;
+
+  pid = spawn ("no-such-file");
+  msg ("spawn(\"no-such-file\"): %d", pid);
+  msg ("wait: %d", wait (pid));
+
+  pid = spawn ("sample.txt");
+  msg ("spawn(\"sample.txt\"): %d", pid);
+  msg ("wait: %d", wait (pid));
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-missing) begin
+load: no-such-file: open failed
+(spawn-missing) spawn("no-such-file"): -1
+(spawn-missing) wait: -1
+load: sample.txt: error loading executable
+(spawn-missing) spawn("sample.txt"): -1
+(spawn-missing) wait: -1
+(spawn-missing) end
+spawn-missing: exit(0)
+EOF
+pass;
@@ -0,0 +1,12 @@
+/* Spawns a subprocess without waiting for it to load, then waits
+   for it to finish. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  msg ("wait(spawn()) = %d", wait (spawn ("child-simple")));
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-simple) begin
+(child-simple) run
+child-simple: exit(81)
+(spawn-simple) wait(spawn()) = 81
+(spawn-simple) end
+spawn-simple: exit(0)
+EOF
+pass;
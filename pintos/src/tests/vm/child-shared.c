@@ -0,0 +1,58 @@
+/* Child process run by the mmap-shared-anon and mmap-shared-file
+   tests.  Maps the object its parent mapped with MAP_SHARED,
+   either the anonymous memory under SHARED_KEY (argument "anon")
+   or "sample.txt" (argument "file"), checks that it sees the
+   parent's data, and writes CHILD_MSG at the start of it.
+
+   With argument "big", instead maps BIG_SIZE bytes of shared
+   anonymous memory and touches every page, which must get it
+   killed once shared pages fill their share of memory. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/mmap-shared.h"
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+
+const char *test_name = "child-shared";
+
+int
+main (int argc UNUSED, char *argv[]) 
+{
+  char *shared = (char *) 0x10000000;
+  size_t i;
+
+  quiet = true;
+
+  if (!strcmp (argv[1], "big"))
+    {
+      CHECK (mmap_ex (BIG_KEY, shared, BIG_SIZE,
+                      MAP_SHARED | MAP_ANONYMOUS) != MAP_FAILED,
+             "map big shared memory");
+      for (i = 0; i < BIG_SIZE; i += 4096)
+        shared[i] = 1;
+      fail ("touched all %d bytes of shared memory", BIG_SIZE);
+    }
+  else if (!strcmp (argv[1], "anon"))
+    {
+      CHECK (mmap_ex (SHARED_KEY, shared, SHARED_SIZE,
+                      MAP_SHARED | MAP_ANONYMOUS) != MAP_FAILED,
+             "map shared memory");
+      for (i = 0; i < SHARED_SIZE; i++)
+        if (shared[i] != (char) (i % 251))
+          fail ("byte %zu of shared memory differs from parent's", i);
+    }
+  else 
+    {
+      int handle;
+
+      CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+      CHECK (mmap_ex (handle, shared, 0, MAP_SHARED) != MAP_FAILED,
+             "map \"sample.txt\" shared");
+      if (memcmp (shared, sample, strlen (sample)))
+        fail ("shared mapping of \"sample.txt\" has bad data");
+    }
+
+  memcpy (shared, CHILD_MSG, strlen (CHILD_MSG));
+  return 0;
+}
@@ -0,0 +1,39 @@
+/* Allocates blocks bigger than a page.  A freed big block at the
+   end of the heap must go back to the kernel, and one below it
+   must be reused for a later allocation that fits. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BIG (100 * 1024)
+
+void
+test_main (void)
+{
+  char *a, *b, *c, *end;
+  size_t i;
+
+  CHECK ((a = malloc (BIG)) != NULL, "malloc %d bytes", BIG);
+  memset (a, 'a', BIG);
+  end = sbrk (0);
+  free (a);
+  CHECK ((char *) sbrk (0) < end, "freed block at end of heap given back");
+
+  CHECK ((a = malloc (BIG / 2)) != NULL, "malloc %d bytes", BIG / 2);
+  CHECK ((b = malloc (BIG / 2)) != NULL, "malloc %d bytes again", BIG / 2);
+  memset (a, 'a', BIG / 2);
+  memset (b, 'b', BIG / 2);
+  end = sbrk (0);
+  free (a);
+  CHECK (sbrk (0) == end, "freed block below the end kept");
+  CHECK ((c = malloc (BIG / 4)) == a, "smaller block reuses it");
+  memset (c, 'c', BIG / 4);
+  for (i = 0; i < BIG / 2; i++)
+    if (b[i] != 'b')
+      fail ("second block corrupt at byte %zu", i);
+  free (c);
+  free (b);
+}
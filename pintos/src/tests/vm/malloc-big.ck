@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(malloc-big) begin
+(malloc-big) malloc 102400 bytes
+(malloc-big) freed block at end of heap given back
+(malloc-big) malloc 51200 bytes
+(malloc-big) malloc 51200 bytes again
+(malloc-big) freed block below the end kept
+(malloc-big) smaller block reuses it
+(malloc-big) end
+malloc-big: exit(0)
+EOF
+pass;
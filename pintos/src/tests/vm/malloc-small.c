@@ -0,0 +1,87 @@
+/* Allocates many small blocks of assorted sizes with malloc and
+   calloc, fills them, frees every other one, grows some with
+   realloc, and checks that no block's contents were disturbed. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_CNT 256
+
+static char *blocks[BLOCK_CNT];
+static size_t sizes[BLOCK_CNT];
+
+/* Checks that block I holds its fill pattern. */
+static void
+verify (int i)
+{
+  size_t j;
+
+  for (j = 0; j < sizes[i]; j++)
+    if (blocks[i][j] != (char) (i + j))
+      fail ("block %d (%zu bytes) corrupt at byte %zu", i, sizes[i], j);
+}
+
+void
+test_main (void)
+{
+  int i;
+  size_t j;
+
+  msg ("allocate %d blocks", BLOCK_CNT);
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      sizes[i] = 1 + (i * 37) % 2000;
+      blocks[i] = i % 2 ? malloc (sizes[i]) : calloc (sizes[i], 1);
+      if (blocks[i] == NULL)
+        fail ("allocating block %d (%zu bytes) failed", i, sizes[i]);
+      if ((uintptr_t) blocks[i] % 8 != 0)
+        fail ("block %d is not 8-byte aligned", i);
+      if (i % 2 == 0)
+        for (j = 0; j < sizes[i]; j++)
+          if (blocks[i][j] != 0)
+            fail ("calloc'd block %d not zeroed at byte %zu", i, j);
+      for (j = 0; j < sizes[i]; j++)
+        blocks[i][j] = i + j;
+    }
+
+  msg ("free every other block");
+  for (i = 0; i < BLOCK_CNT; i += 2)
+    {
+      verify (i);
+      free (blocks[i]);
+      blocks[i] = NULL;
+    }
+
+  msg ("grow the rest with realloc");
+  for (i = 1; i < BLOCK_CNT; i += 2)
+    {
+      blocks[i] = realloc (blocks[i], sizes[i] * 2);
+      if (blocks[i] == NULL)
+        fail ("realloc of block %d failed", i);
+      verify (i);
+      sizes[i] *= 2;
+      for (j = 0; j < sizes[i]; j++)
+        blocks[i][j] = i + j;
+    }
+
+  msg ("reallocate the freed blocks");
+  for (i = 0; i < BLOCK_CNT; i += 2)
+    {
+      blocks[i] = malloc (sizes[i]);
+      if (blocks[i] == NULL)
+        fail ("allocating block %d again failed", i);
+      for (j = 0; j < sizes[i]; j++)
+        blocks[i][j] = i + j;
+    }
+
+  msg ("verify and free all blocks");
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      verify (i);
+      free (blocks[i]);
+    }
+  free (NULL);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(malloc-small) begin
+(malloc-small) allocate 256 blocks
+(malloc-small) free every other block
+(malloc-small) grow the rest with realloc
+(malloc-small) reallocate the freed blocks
+(malloc-small) verify and free all blocks
+(malloc-small) end
+malloc-small: exit(0)
+EOF
+pass;
@@ -0,0 +1,42 @@
+/* Maps private anonymous memory, checks that it starts out
+   zeroed and holds what is written to it, then unmaps it and
+   maps it again to check that the old contents are gone. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define SIZE (3 * 4096)
+
+static void
+check_zeros (void) 
+{
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    if (ACTUAL[i] != 0)
+      fail ("byte %zu of anonymous memory is %d, not 0", i, ACTUAL[i]);
+}
+
+void
+test_main (void)
+{
+  mapid_t map;
+  size_t i;
+
+  CHECK ((map = mmap_ex (-1, ACTUAL, SIZE, MAP_ANONYMOUS)) != MAP_FAILED,
+         "map anonymous memory");
+  check_zeros ();
+  for (i = 0; i < SIZE; i++)
+    ACTUAL[i] = i % 251;
+  for (i = 0; i < SIZE; i++)
+    if (ACTUAL[i] != (char) (i % 251))
+      fail ("byte %zu of anonymous memory lost its value", i);
+  munmap (map);
+
+  CHECK ((map = mmap_ex (-1, ACTUAL, SIZE, MAP_ANONYMOUS)) != MAP_FAILED,
+         "map anonymous memory again");
+  check_zeros ();
+  munmap (map);
+}
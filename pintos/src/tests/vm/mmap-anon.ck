@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-anon) begin
+(mmap-anon) map anonymous memory
+(mmap-anon) map anonymous memory again
+(mmap-anon) end
+mmap-anon: exit(0)
+EOF
+pass;
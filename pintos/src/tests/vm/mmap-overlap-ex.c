@@ -0,0 +1,41 @@
+/* Verifies that mmap_ex refuses anonymous and shared mappings
+   that overlap an existing mapping, the code segment, or the
+   stack, and shared mappings larger than the object they join. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define PAGE 4096
+
+void
+test_main (void)
+{
+  char *code = (char *) ((unsigned) test_main & ~(PAGE - 1));
+  char *stack = (char *) ((unsigned) &code & ~(PAGE - 1));
+  int handle;
+
+  CHECK (mmap_ex (-1, ACTUAL, 2 * PAGE, MAP_ANONYMOUS) != MAP_FAILED,
+         "map anonymous memory");
+  CHECK (mmap_ex (-1, ACTUAL + PAGE, 2 * PAGE, MAP_ANONYMOUS) == MAP_FAILED,
+         "try to map anonymous memory over it");
+  CHECK (mmap_ex (7, ACTUAL - PAGE, 2 * PAGE,
+                  MAP_SHARED | MAP_ANONYMOUS) == MAP_FAILED,
+         "try to map shared memory over it");
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap_ex (handle, ACTUAL, 0, MAP_SHARED) == MAP_FAILED,
+         "try to map \"sample.txt\" shared over it");
+
+  CHECK (mmap_ex (-1, code, PAGE, MAP_ANONYMOUS) == MAP_FAILED,
+         "try to map anonymous memory over code");
+  CHECK (mmap_ex (7, stack, PAGE, MAP_SHARED | MAP_ANONYMOUS) == MAP_FAILED,
+         "try to map shared memory over stack");
+
+  CHECK (mmap_ex (7, ACTUAL + 2 * PAGE, PAGE,
+                  MAP_SHARED | MAP_ANONYMOUS) != MAP_FAILED,
+         "map one page of shared memory");
+  CHECK (mmap_ex (7, ACTUAL + 4 * PAGE, 2 * PAGE,
+                  MAP_SHARED | MAP_ANONYMOUS) == MAP_FAILED,
+         "try to map two pages of the same shared memory");
+}
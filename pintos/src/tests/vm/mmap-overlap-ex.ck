@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-overlap-ex) begin
+(mmap-overlap-ex) map anonymous memory
+(mmap-overlap-ex) try to map anonymous memory over it
+(mmap-overlap-ex) try to map shared memory over it
+(mmap-overlap-ex) open "sample.txt"
+(mmap-overlap-ex) try to map "sample.txt" shared over it
+(mmap-overlap-ex) try to map anonymous memory over code
+(mmap-overlap-ex) try to map shared memory over stack
+(mmap-overlap-ex) map one page of shared memory
+(mmap-overlap-ex) try to map two pages of the same shared memory
+(mmap-overlap-ex) end
+mmap-overlap-ex: exit(0)
+EOF
+pass;
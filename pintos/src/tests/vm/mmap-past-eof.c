@@ -0,0 +1,46 @@
+/* Maps "sample.txt" and an empty file privately with a length
+   that runs past their ends.  The pages past the end must read
+   as zeros, and writing to them must change neither file once
+   the mappings go away. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define SIZE (3 * 4096)
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap_ex (handle, ACTUAL, SIZE, MAP_PRIVATE)) != MAP_FAILED,
+         "map \"sample.txt\" past its end");
+  if (memcmp (ACTUAL, sample, strlen (sample)))
+    fail ("read of mmap'd file reported bad data");
+  for (i = strlen (sample); i < SIZE; i++)
+    if (ACTUAL[i] != 0)
+      fail ("byte %zu past end of file is %d, not 0", i, ACTUAL[i]);
+  memset (ACTUAL + strlen (sample), 'x', SIZE - strlen (sample));
+  munmap (map);
+  close (handle);
+  check_file ("sample.txt", sample, strlen (sample));
+
+  CHECK (create ("empty", 0), "create \"empty\"");
+  CHECK ((handle = open ("empty")) > 1, "open \"empty\"");
+  CHECK ((map = mmap_ex (handle, ACTUAL, SIZE, MAP_PRIVATE)) != MAP_FAILED,
+         "map \"empty\"");
+  for (i = 0; i < SIZE; i++)
+    if (ACTUAL[i] != 0)
+      fail ("byte %zu of empty file is %d, not 0", i, ACTUAL[i]);
+  memset (ACTUAL, 'x', SIZE);
+  munmap (map);
+  CHECK (filesize (handle) == 0, "\"empty\" is still empty");
+  close (handle);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-past-eof) begin
+(mmap-past-eof) open "sample.txt"
+(mmap-past-eof) map "sample.txt" past its end
+(mmap-past-eof) open "sample.txt" for verification
+(mmap-past-eof) verified contents of "sample.txt"
+(mmap-past-eof) close "sample.txt"
+(mmap-past-eof) create "empty"
+(mmap-past-eof) open "empty"
+(mmap-past-eof) map "empty"
+(mmap-past-eof) "empty" is still empty
+(mmap-past-eof) end
+mmap-past-eof: exit(0)
+EOF
+pass;
@@ -0,0 +1,37 @@
+/* Maps shared anonymous memory under a key, fills it in, and
+   runs a child that maps the same key at another address.  The
+   child must see the parent's data, and the parent must see what
+   the child wrote. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/mmap-shared.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x20000000)
+
+void
+test_main (void)
+{
+  mapid_t map;
+  pid_t child;
+  size_t i;
+
+  CHECK ((map = mmap_ex (SHARED_KEY, ACTUAL, SHARED_SIZE,
+                         MAP_SHARED | MAP_ANONYMOUS)) != MAP_FAILED,
+         "map shared memory");
+  for (i = 0; i < SHARED_SIZE; i++)
+    ACTUAL[i] = i % 251;
+
+  CHECK ((child = exec ("child-shared anon")) != -1,
+         "exec \"child-shared anon\"");
+  CHECK (wait (child) == 0, "wait for child (should return 0)");
+
+  CHECK (!memcmp (ACTUAL, CHILD_MSG, strlen (CHILD_MSG)),
+         "child's write is visible");
+  for (i = strlen (CHILD_MSG); i < SHARED_SIZE; i++)
+    if (ACTUAL[i] != (char) (i % 251))
+      fail ("byte %zu of shared memory changed", i);
+  munmap (map);
+}
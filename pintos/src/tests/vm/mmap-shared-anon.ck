@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-shared-anon) begin
+(mmap-shared-anon) map shared memory
+(mmap-shared-anon) exec "child-shared anon"
+child-shared: exit(0)
+(mmap-shared-anon) wait for child (should return 0)
+(mmap-shared-anon) child's write is visible
+(mmap-shared-anon) end
+mmap-shared-anon: exit(0)
+EOF
+pass;
@@ -0,0 +1,37 @@
+/* Runs a child that maps more shared anonymous memory than there
+   is physical memory and touches all of it.  The child must be
+   killed without taking the rest of the system with it: the
+   parent must still be able to fault in private pages and to map
+   and use shared memory afterward. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/mmap-shared.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x20000000)
+#define PRIVATE_SIZE (64 * 4096)
+
+static char private[PRIVATE_SIZE];
+
+void
+test_main (void)
+{
+  mapid_t map;
+  size_t i;
+
+  msg ("wait(exec()) = %d", wait (exec ("child-shared big")));
+
+  memset (private, 'x', sizeof private);
+  for (i = 0; i < sizeof private; i++)
+    if (private[i] != 'x')
+      fail ("byte %zu of private memory lost its value", i);
+  msg ("private memory still works");
+
+  CHECK ((map = mmap_ex (BIG_KEY, ACTUAL, SHARED_SIZE,
+                         MAP_SHARED | MAP_ANONYMOUS)) != MAP_FAILED,
+         "map shared memory");
+  memset (ACTUAL, 'y', SHARED_SIZE);
+  munmap (map);
+}
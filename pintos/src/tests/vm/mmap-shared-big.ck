@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-shared-big) begin
+child-shared: exit(-1)
+(mmap-shared-big) wait(exec()) = -1
+(mmap-shared-big) private memory still works
+(mmap-shared-big) map shared memory
+(mmap-shared-big) end
+mmap-shared-big: exit(0)
+EOF
+pass;
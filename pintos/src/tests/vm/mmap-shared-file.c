@@ -0,0 +1,41 @@
+/* Maps "sample.txt" with MAP_SHARED and runs a child that maps
+   it too and writes to it.  The parent must see the write
+   through its own mapping, and the write must reach the file,
+   without changing its size, once the last mapping goes away. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/mmap-shared.h"
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x20000000)
+
+void
+test_main (void)
+{
+  char expected[sizeof sample];
+  int handle;
+  mapid_t map;
+  pid_t child;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap_ex (handle, ACTUAL, 0, MAP_SHARED)) != MAP_FAILED,
+         "map \"sample.txt\" shared");
+  if (memcmp (ACTUAL, sample, strlen (sample)))
+    fail ("read of shared mapping reported bad data");
+
+  CHECK ((child = exec ("child-shared file")) != -1,
+         "exec \"child-shared file\"");
+  CHECK (wait (child) == 0, "wait for child (should return 0)");
+
+  CHECK (!memcmp (ACTUAL, CHILD_MSG, strlen (CHILD_MSG)),
+         "child's write is visible");
+  munmap (map);
+  close (handle);
+
+  memcpy (expected, sample, sizeof sample);
+  memcpy (expected, CHILD_MSG, strlen (CHILD_MSG));
+  check_file ("sample.txt", expected, strlen (sample));
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-shared-file) begin
+(mmap-shared-file) open "sample.txt"
+(mmap-shared-file) map "sample.txt" shared
+(mmap-shared-file) exec "child-shared file"
+child-shared: exit(0)
+(mmap-shared-file) wait for child (should return 0)
+(mmap-shared-file) child's write is visible
+(mmap-shared-file) open "sample.txt" for verification
+(mmap-shared-file) verified contents of "sample.txt"
+(mmap-shared-file) close "sample.txt"
+(mmap-shared-file) end
+mmap-shared-file: exit(0)
+EOF
+pass;
@@ -0,0 +1,17 @@
+#ifndef TESTS_VM_MMAP_SHARED
+#define TESTS_VM_MMAP_SHARED 1
+
+/* Key under which mmap-shared-anon and child-shared map their
+   shared anonymous memory, and the size of that memory. */
+#define SHARED_KEY 42
+#define SHARED_SIZE (2 * 4096)
+
+/* Key and size of the shared anonymous memory child-shared maps
+   for mmap-shared-big: more than all of physical memory. */
+#define BIG_KEY 43
+#define BIG_SIZE (4 * 1024 * 1024)
+
+/* What child-shared writes at the start of the shared object. */
+#define CHILD_MSG "written by child-shared"
+
+#endif /* tests/vm/mmap-shared.h */
@@ -0,0 +1,38 @@
+/* Grows the heap with sbrk, checks that the new pages read as
+   zeros and hold what is written to them, shrinks it, and grows
+   it again over the dropped pages, which must read as zeros
+   again. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE 4096
+
+void
+test_main (void)
+{
+  char *start = sbrk (0);
+  size_t i;
+
+  CHECK (start != (char *) -1, "sbrk (0)");
+  CHECK (sbrk (3 * PAGE) == start, "grow heap by 3 pages");
+  CHECK (sbrk (0) == start + 3 * PAGE, "heap end moved up 3 pages");
+  for (i = 0; i < 3 * PAGE; i++)
+    if (start[i] != 0)
+      fail ("byte %zu of new heap is %d, not 0", i, start[i]);
+  for (i = 0; i < 3 * PAGE; i++)
+    start[i] = i % 251;
+
+  CHECK (sbrk (-2 * PAGE) == start + 3 * PAGE, "shrink heap by 2 pages");
+  CHECK (sbrk (0) == start + PAGE, "heap end moved down 2 pages");
+  for (i = 0; i < PAGE; i++)
+    if (start[i] != (char) (i % 251))
+      fail ("byte %zu of kept heap page changed", i);
+
+  CHECK (sbrk (2 * PAGE) == start + PAGE, "grow heap by 2 pages again");
+  for (i = PAGE; i < 3 * PAGE; i++)
+    if (start[i] != 0)
+      fail ("byte %zu of regrown heap is %d, not 0", i, start[i]);
+}
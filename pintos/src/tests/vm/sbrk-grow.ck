@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sbrk-grow) begin
+(sbrk-grow) sbrk (0)
+(sbrk-grow) grow heap by 3 pages
+(sbrk-grow) heap end moved up 3 pages
+(sbrk-grow) shrink heap by 2 pages
+(sbrk-grow) heap end moved down 2 pages
+(sbrk-grow) grow heap by 2 pages again
+(sbrk-grow) end
+sbrk-grow: exit(0)
+EOF
+pass;
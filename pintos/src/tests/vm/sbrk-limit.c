@@ -0,0 +1,23 @@
+/* Tries to move the end of the heap below its start and into the
+   area reserved for the stack.  sbrk must refuse both and leave
+   the heap as it was. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* How far the stack may grow below PHYS_BASE. */
+#define STACK_LIMIT (8 * 1024 * 1024)
+
+void
+test_main (void)
+{
+  char *start = sbrk (0);
+  char *stack_area = (char *) 0xc0000000 - STACK_LIMIT;
+
+  CHECK (sbrk (-1) == (void *) -1, "try to shrink heap below its start");
+  CHECK (sbrk (stack_area - start + 1) == (void *) -1,
+         "try to grow heap into the stack area");
+  CHECK (sbrk (0) == start, "heap end unchanged");
+  CHECK (sbrk (4096) == start, "grow heap by 1 page");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sbrk-limit) begin
+(sbrk-limit) try to shrink heap below its start
+(sbrk-limit) try to grow heap into the stack area
+(sbrk-limit) heap end unchanged
+(sbrk-limit) grow heap by 1 page
+(sbrk-limit) end
+sbrk-limit: exit(0)
+EOF
+pass;
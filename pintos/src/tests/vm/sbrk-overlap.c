@@ -0,0 +1,28 @@
+/* Maps a file just above the end of the heap, then tries to grow
+   the heap over it, which must fail and leave the heap as it was.
+   Growing up to the mapping must still work. */
+
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE 4096
+
+void
+test_main (void)
+{
+  char *start = sbrk (0);
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (handle, start + 2 * PAGE) != MAP_FAILED,
+         "mmap \"sample.txt\" 2 pages above the heap");
+  CHECK (sbrk (4 * PAGE) == (void *) -1, "try to grow heap over the mapping");
+  CHECK (sbrk (0) == start, "heap end unchanged");
+  CHECK (sbrk (2 * PAGE) == start, "grow heap up to the mapping");
+  start[2 * PAGE - 1] = 1;
+  if (start[2 * PAGE] != sample[0])
+    fail ("mapping changed under the heap");
+  CHECK (sbrk (1) == (void *) -1, "try to grow heap by 1 more byte");
+}
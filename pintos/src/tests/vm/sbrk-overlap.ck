@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sbrk-overlap) begin
+(sbrk-overlap) open "sample.txt"
+(sbrk-overlap) mmap "sample.txt" 2 pages above the heap
+(sbrk-overlap) try to grow heap over the mapping
+(sbrk-overlap) heap end unchanged
+(sbrk-overlap) grow heap up to the mapping
+(sbrk-overlap) try to grow heap by 1 more byte
+(sbrk-overlap) end
+sbrk-overlap: exit(0)
+EOF
+pass;
@@ -0,0 +1,21 @@
+/* Shrinks the heap with sbrk and then reads from a page it gave
+   back.  The process must be terminated with -1 exit code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE 4096
+
+void
+test_main (void)
+{
+  char *start = sbrk (0);
+
+  CHECK (sbrk (2 * PAGE) == start, "grow heap by 2 pages");
+  start[0] = start[PAGE] = 1;
+  CHECK (sbrk (-PAGE) == start + 2 * PAGE, "shrink heap by 1 page");
+  msg ("kept page: %d", start[0]);
+  msg ("dropped page: %d", *(volatile char *) (start + PAGE));
+  fail ("survived reading a dropped heap page");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sbrk-shrink) begin
+(sbrk-shrink) grow heap by 2 pages
+(sbrk-shrink) shrink heap by 1 page
+(sbrk-shrink) kept page: 1
+sbrk-shrink: exit(-1)
+EOF
+pass;
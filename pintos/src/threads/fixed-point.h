@@ -0,0 +1,59 @@
+#ifndef THREADS_FIXED_POINT_H
+#define THREADS_FIXED_POINT_H
+
+#include <stdint.h>
+
+/* Signed 17.14 fixed-point arithmetic, used by the 4.4BSD
+   scheduler for load_avg and recent_cpu.  The kernel cannot use
+   floating point, so a real number X is stored as the integer
+   X * 2**14.  Products and quotients of two fixed-point values
+   go through 64 bits so that the intermediate does not
+   overflow. */
+typedef int fixed_t;
+
+#define FP_SHIFT 14
+#define FP_ONE (1 << FP_SHIFT)
+
+/* Converts integer N to fixed point. */
+static inline fixed_t
+fp_from_int (int n)
+{
+  return n * FP_ONE;
+}
+
+/* Converts X to an integer, rounding toward zero. */
+static inline int
+fp_trunc (fixed_t x)
+{
+  return x / FP_ONE;
+}
+
+/* Converts X to an integer, rounding to nearest. */
+static inline int
+fp_round (fixed_t x)
+{
+  return x >= 0 ? (x + FP_ONE / 2) / FP_ONE : (x - FP_ONE / 2) / FP_ONE;
+}
+
+/* Returns X + N, for integer N. */
+static inline fixed_t
+fp_add_int (fixed_t x, int n)
+{
+  return x + n * FP_ONE;
+}
+
+/* Returns X * Y. */
+static inline fixed_t
+fp_mul (fixed_t x, fixed_t y)
+{
+  return ((int64_t) x) * y / FP_ONE;
+}
+
+/* Returns X / Y. */
+static inline fixed_t
+fp_div (fixed_t x, fixed_t y)
+{
+  return ((int64_t) x) * FP_ONE / y;
+}
+
+#endif /* threads/fixed-point.h */
@@ -19,9 +19,11 @@
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
+#include "threads/memstat.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -35,6 +37,7 @@
 #include "vm/page.h"
 #include "vm/frame.h"
 #include "vm/swap.h"
+#include "vm/shm.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -63,6 +66,9 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* -memleak: Track outstanding allocations by call site? */
+static bool track_leaks;
+
 static void bss_init (void);
 static void paging_init (void);
 
@@ -70,6 +76,8 @@ static char **read_command_line (void);
 static char **parse_options (char **argv);
 static void run_actions (char **argv);
 static void usage (void);
+static void parse_time_slices (char *value);
+static void print_memory (char **argv);
 
 #ifdef FILESYS
 static void locate_block_devices (void);
@@ -103,11 +111,14 @@ main (void)
   /* Initialize memory system. */
   palloc_init (user_page_limit);
   malloc_init ();
+  if (track_leaks)
+    memleak_init ();
   paging_init ();
 
 #ifdef VM
   spt_init ();
   ft_init ();
+  shm_init ();
 #endif
 
   /* Segmentation. */
@@ -124,10 +135,12 @@ main (void)
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  process_init ();
 #endif
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  workqueue_init ();
   serial_init_queue ();
   timer_calibrate ();
 
@@ -177,7 +190,8 @@ paging_init (void)
   size_t page;
   extern char _start, _end_kernel_text;
 
-  pd = init_page_dir = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  pd = init_page_dir = palloc_get_page (PAL_ASSERT | PAL_ZERO
+                                        | PAL_TAG (MEM_PAGEDIR));
   pt = NULL;
   for (page = 0; page < init_ram_pages; page++)
     {
@@ -189,7 +203,7 @@ paging_init (void)
 
       if (pd[pde_idx] == 0)
         {
-          pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+          pt = palloc_get_page (PAL_ASSERT | PAL_ZERO | PAL_TAG (MEM_PAGEDIR));
           pd[pde_idx] = pde_create (pt);
         }
 
@@ -272,6 +286,10 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-slice"))
+        parse_time_slices (value);
+      else if (!strcmp (name, "-memleak"))
+        track_leaks = true;
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
@@ -293,6 +311,34 @@ parse_options (char **argv)
   return argv;
 }
 
+/* Parses the comma-separated time slices in VALUE, one per
+   priority band starting from the lowest.  Bands not listed keep
+   their default. */
+static void
+parse_time_slices (char *value) 
+{
+  char *slice, *save_ptr;
+  int band = 0;
+
+  if (value == NULL)
+    PANIC ("-slice requires a value");
+  for (slice = strtok_r (value, ",", &save_ptr); slice != NULL;
+       slice = strtok_r (NULL, ",", &save_ptr))
+    {
+      int ticks = atoi (slice);
+      if (band >= PRI_BAND_CNT || ticks <= 0)
+        PANIC ("bad time slice list for -slice");
+      thread_set_time_slice (band++, ticks);
+    }
+}
+
+/* Prints kernel memory usage. */
+static void
+print_memory (char **argv UNUSED) 
+{
+  mem_print_stats ();
+}
+
 /* Runs the task specified in ARGV[1]. */
 static void
 run_task (char **argv)
@@ -325,6 +371,7 @@ run_actions (char **argv)
   static const struct action actions[] = 
     {
       {"run", 2, run_task},
+      {"memstat", 1, print_memory},
 #ifdef FILESYS
       {"ls", 1, fsutil_ls},
       {"cat", 2, fsutil_cat},
@@ -373,6 +420,7 @@ usage (void)
 #else
           "  run TEST           Run TEST.\n"
 #endif
+          "  memstat            Print kernel memory usage.\n"
 #ifdef FILESYS
           "  ls                 List files in the root directory.\n"
           "  cat FILE           Print FILE to the console.\n"
@@ -395,6 +443,8 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -slice=T0,T1,...   Give priority band N (0=lowest) TN-tick time slices.\n"
+          "  -memleak           Report allocations still live at shutdown.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -1,5 +1,6 @@
 #include "threads/malloc.h"
 #include <debug.h>
+#include <inttypes.h>
 #include <list.h>
 #include <round.h>
 #include <stdint.h>
@@ -32,7 +33,16 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   (addition) Rounding to a power of 2 wastes up to half of each
+   block, so between powers of 2 there are also descriptors in
+   quarter steps (..., 512, 640, 768, 896, 1024, ...), never
+   finer than 8 bytes.  A table indexed by size / 8 finds the
+   descriptor for a request without scanning.  Freed big blocks
+   are kept in a small cache and reused by later big requests of
+   about the same size instead of going back to the page
+   allocator every time. */
 
 /* Descriptor. */
 struct desc
@@ -41,6 +51,9 @@ struct desc
     size_t blocks_per_arena;    /* Number of blocks in an arena. */
     struct list free_list;      /* List of free blocks. */
     struct lock lock;           /* Lock. */
+    size_t in_use;              /* Blocks handed out (addition). */
+    size_t in_use_peak;         /* High-water mark of IN_USE (addition). */
+    uint64_t alloc_cnt;         /* Allocations ever made (addition). */
   };
 
 /* Magic number for detecting arena corruption. */
@@ -61,9 +74,34 @@ struct block
   };
 
 /* Our set of descriptors. */
-static struct desc descs[10];   /* Descriptors. */
+static struct desc descs[32];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+/* (addition) Granularity of descriptor sizes and of the lookup
+   table below. */
+#define DESC_STEP 8
+
+/* (addition) Largest size served by a descriptor. */
+static size_t desc_max_size;
+
+/* (addition) Index into descs[] of the smallest descriptor for
+   each size, in DESC_STEP-byte units, up to DESC_MAX_SIZE. */
+static uint8_t desc_lookup[PGSIZE / 2 / DESC_STEP + 1];
+
+/* (addition) Cache of freed big blocks, most recent first.  A
+   cached block is reused for any request needing between its
+   page count less a quarter and its page count. */
+#define BIG_CACHE_PAGES 32      /* Max pages held in the cache. */
+static struct list big_cache;   /* Cached big blocks' arenas. */
+static size_t big_cache_pages;  /* Pages in BIG_CACHE. */
+static struct lock big_lock;    /* Protects BIG_CACHE and below. */
+static size_t big_in_use;       /* Big blocks handed out. */
+static size_t big_in_use_peak;  /* High-water mark of BIG_IN_USE. */
+
+static void *big_get (size_t page_cnt);
+static void big_put (struct arena *);
+static void *malloc_at (size_t, const void *site); //addition
+
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
 
@@ -71,23 +109,55 @@ static struct block *arena_to_block (struct arena *, size_t idx);
 void
 malloc_init (void) 
 {
-  size_t block_size;
+  size_t power, block_size;
+  size_t size, i;
 
-  for (block_size = 16; block_size < PGSIZE / 2; block_size *= 2)
+  /* Each power of 2 and the quarter steps up to the next one
+     (addition), as long as an arena holds at least 2 blocks. */
+  for (power = 16; ; power *= 2)
     {
-      struct desc *d = &descs[desc_cnt++];
-      ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
-      d->block_size = block_size;
-      d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
-      list_init (&d->free_list);
-      lock_init (&d->lock);
+      size_t step = power / 4 > DESC_STEP ? power / 4 : DESC_STEP;
+      for (block_size = power; block_size < power * 2; block_size += step)
+        {
+          struct desc *d;
+          if ((PGSIZE - sizeof (struct arena)) / block_size < 2)
+            goto done;
+          d = &descs[desc_cnt++];
+          ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
+          d->block_size = block_size;
+          d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
+          list_init (&d->free_list);
+          lock_init (&d->lock);
+        }
     }
+ done:
+  desc_max_size = descs[desc_cnt - 1].block_size;
+  ASSERT (desc_max_size / DESC_STEP < sizeof desc_lookup);
+
+  /* Fill in the lookup table (addition). */
+  for (size = 0, i = 0; size <= desc_max_size; size += DESC_STEP)
+    {
+      while (descs[i].block_size < size)
+        i++;
+      desc_lookup[size / DESC_STEP] = i;
+    }
+
+  list_init (&big_cache);
+  lock_init (&big_lock);
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
    Returns a null pointer if memory is not available. */
 void *
 malloc (size_t size) 
+{
+  return malloc_at (size, __builtin_return_address (0));
+}
+
+/* (addition) Does the work of malloc() on behalf of a call from
+   SITE, for leak tracking. */
+static void *
+malloc_at (size_t size, const void *site)
 {
   struct desc *d;
   struct block *b;
@@ -99,25 +169,18 @@ malloc (size_t size)
 
   /* Find the smallest descriptor that satisfies a SIZE-byte
      request. */
-  for (d = descs; d < descs + desc_cnt; d++)
-    if (d->block_size >= size)
-      break;
-  if (d == descs + desc_cnt) 
+  if (size > desc_max_size) 
     {
       /* SIZE is too big for any descriptor.
          Allocate enough pages to hold SIZE plus an arena. */
       size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
-      a = palloc_get_multiple (0, page_cnt);
+      a = big_get (page_cnt); //addition
       if (a == NULL)
         return NULL;
-
-      /* Initialize the arena to indicate a big block of PAGE_CNT
-         pages, and return it. */
-      a->magic = ARENA_MAGIC;
-      a->desc = NULL;
-      a->free_cnt = page_cnt;
+      memleak_record (a + 1, size, site);
       return a + 1;
     }
+  d = &descs[desc_lookup[DIV_ROUND_UP (size, DESC_STEP)]]; //addition
 
   lock_acquire (&d->lock);
 
@@ -127,7 +190,7 @@ malloc (size_t size)
       size_t i;
 
       /* Allocate a page. */
-      a = palloc_get_page (0);
+      a = palloc_get_page (PAL_TAG (MEM_MALLOC));
       if (a == NULL) 
         {
           lock_release (&d->lock);
@@ -149,7 +212,11 @@ malloc (size_t size)
   b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
   a = block_to_arena (b);
   a->free_cnt--;
+  d->alloc_cnt++;
+  if (++d->in_use > d->in_use_peak)
+    d->in_use_peak = d->in_use;
   lock_release (&d->lock);
+  memleak_record (b, size, site);
   return b;
 }
 
@@ -167,7 +234,7 @@ calloc (size_t a, size_t b)
     return NULL;
 
   /* Allocate and zero memory. */
-  p = malloc (size);
+  p = malloc_at (size, __builtin_return_address (0));
   if (p != NULL)
     memset (p, 0, size);
 
@@ -201,7 +268,7 @@ realloc (void *old_block, size_t new_size)
     }
   else 
     {
-      void *new_block = malloc (new_size);
+      void *new_block = malloc_at (new_size, __builtin_return_address (0));
       if (old_block != NULL && new_block != NULL)
         {
           size_t old_size = block_size (old_block);
@@ -223,7 +290,8 @@ free (void *p)
       struct block *b = p;
       struct arena *a = block_to_arena (b);
       struct desc *d = a->desc;
-      
+
+      memleak_forget (p); //addition
       if (d != NULL) 
         {
           /* It's a normal block.  We handle it here. */
@@ -237,6 +305,7 @@ free (void *p)
 
           /* Add block to free list. */
           list_push_front (&d->free_list, &b->free_elem);
+          d->in_use--;
 
           /* If the arena is now entirely unused, free it. */
           if (++a->free_cnt >= d->blocks_per_arena) 
@@ -256,13 +325,121 @@ free (void *p)
         }
       else
         {
-          /* It's a big block.  Free its pages. */
-          palloc_free_multiple (a, a->free_cnt);
+          /* It's a big block.  Cache it or free its pages. */
+          big_put (a); //addition
           return;
         }
     }
 }
 
+/* (addition) Returns the arena of a big block of at least
+   PAGE_CNT pages, reusing a cached one if possible.  Returns a
+   null pointer if memory is not available. */
+static void *
+big_get (size_t page_cnt)
+{
+  struct arena *a = NULL;
+  struct list_elem *e;
+
+  lock_acquire (&big_lock);
+  for (e = list_begin (&big_cache); e != list_end (&big_cache);
+       e = list_next (e))
+    {
+      struct arena *c = block_to_arena (list_entry (e, struct block,
+                                                    free_elem));
+      if (c->free_cnt >= page_cnt && c->free_cnt - c->free_cnt / 4 <= page_cnt)
+        {
+          list_remove (e);
+          big_cache_pages -= c->free_cnt;
+          a = c;
+          break;
+        }
+    }
+  lock_release (&big_lock);
+
+  if (a == NULL)
+    {
+      a = palloc_get_multiple (PAL_TAG (MEM_MALLOC), page_cnt);
+      if (a == NULL)
+        {
+          /* Cached blocks may be what the page allocator is
+             missing; give them back and try once more. */
+          lock_acquire (&big_lock);
+          while (!list_empty (&big_cache))
+            {
+              struct arena *c = block_to_arena (
+                list_entry (list_pop_front (&big_cache), struct block,
+                            free_elem));
+              big_cache_pages -= c->free_cnt;
+              palloc_free_multiple (c, c->free_cnt);
+            }
+          lock_release (&big_lock);
+          a = palloc_get_multiple (PAL_TAG (MEM_MALLOC), page_cnt);
+          if (a == NULL)
+            return NULL;
+        }
+
+      /* Initialize the arena to indicate a big block of PAGE_CNT
+         pages. */
+      a->magic = ARENA_MAGIC;
+      a->desc = NULL;
+      a->free_cnt = page_cnt;
+    }
+
+  lock_acquire (&big_lock);
+  if (++big_in_use > big_in_use_peak)
+    big_in_use_peak = big_in_use;
+  lock_release (&big_lock);
+  return a;
+}
+
+/* (addition) Puts big block arena A into the big block cache,
+   evicting the oldest cached blocks to make room, or frees it if
+   it is too large to cache. */
+static void
+big_put (struct arena *a)
+{
+  lock_acquire (&big_lock);
+  big_in_use--;
+  if (a->free_cnt > BIG_CACHE_PAGES)
+    {
+      lock_release (&big_lock);
+      palloc_free_multiple (a, a->free_cnt);
+      return;
+    }
+
+  while (big_cache_pages + a->free_cnt > BIG_CACHE_PAGES)
+    {
+      struct arena *c = block_to_arena (list_entry (list_pop_back (&big_cache),
+                                                    struct block, free_elem));
+      big_cache_pages -= c->free_cnt;
+      palloc_free_multiple (c, c->free_cnt);
+    }
+  list_push_front (&big_cache, &((struct block *) (a + 1))->free_elem);
+  big_cache_pages += a->free_cnt;
+  lock_release (&big_lock);
+}
+
+/* (addition) Prints block usage for each descriptor that has
+   been used, and for big blocks. */
+void
+malloc_print_stats (void)
+{
+  size_t i;
+
+  for (i = 0; i < desc_cnt; i++)
+    {
+      struct desc *d = &descs[i];
+      if (d->alloc_cnt > 0)
+        printf ("Malloc %zu-byte blocks: %"PRIu64" allocated, "
+                "%zu in use (%zu peak)\n", d->block_size, d->alloc_cnt,
+                d->in_use, d->in_use_peak);
+    }
+  if (big_in_use_peak > 0)
+    printf ("Malloc big blocks: %zu in use (%zu peak), %zu pages cached\n",
+            big_in_use, big_in_use_peak, big_cache_pages);
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b)
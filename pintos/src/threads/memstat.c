@@ -0,0 +1,252 @@
+#include "threads/memstat.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/slab.h"
+#include "threads/vaddr.h"
+
+/* Live and peak bytes for one tag. */
+struct mem_counter
+  {
+    size_t bytes;               /* Currently allocated. */
+    size_t peak;                /* High-water mark of BYTES. */
+  };
+
+static struct mem_counter counters[MEM_TAG_CNT];
+
+static const char *tag_names[MEM_TAG_CNT] =
+  {
+    "other", "thread", "pagedir", "malloc",
+    "slab", "cache", "frame", "process",
+  };
+
+/* Leak tracking.
+
+   Outstanding allocations are kept in an open-addressed hash
+   table keyed on address, with linear probing.  Deletion shifts
+   later members of the probe chain back, so there are no
+   tombstones.  The table has a fixed size; allocations that do
+   not fit are only counted. */
+
+/* Pages in the leak table. */
+#define LEAK_PAGES 16
+
+/* An outstanding allocation. */
+struct leak_rec
+  {
+    const void *ptr;            /* Block, null if slot is empty. */
+    const void *site;           /* Caller of the allocator. */
+    size_t bytes;               /* Size. */
+  };
+
+static struct leak_rec *leaks;  /* Table, null if not tracking. */
+static size_t leak_cap;         /* Number of slots. */
+static size_t leak_cnt;         /* Slots in use. */
+static unsigned leak_dropped;   /* Allocations that did not fit. */
+
+static size_t leak_home (const void *);
+static struct leak_rec *leak_find (const void *);
+static void leak_report (void);
+
+/* Charges BYTES to TAG. */
+void
+memstat_alloc (enum mem_tag tag, size_t bytes)
+{
+  enum intr_level old_level;
+  struct mem_counter *c;
+
+  ASSERT (tag < MEM_TAG_CNT);
+  c = &counters[tag];
+  old_level = intr_disable ();
+  c->bytes += bytes;
+  if (c->bytes > c->peak)
+    c->peak = c->bytes;
+  intr_set_level (old_level);
+}
+
+/* Credits BYTES back to TAG. */
+void
+memstat_free (enum mem_tag tag, size_t bytes)
+{
+  enum intr_level old_level;
+
+  ASSERT (tag < MEM_TAG_CNT);
+  old_level = intr_disable ();
+  ASSERT (counters[tag].bytes >= bytes);
+  counters[tag].bytes -= bytes;
+  intr_set_level (old_level);
+}
+
+/* Starts tracking outstanding allocations.  Allocations made
+   earlier are not tracked. */
+void
+memleak_init (void)
+{
+  struct leak_rec *table = palloc_get_multiple (PAL_ASSERT | PAL_ZERO,
+                                                LEAK_PAGES);
+  leak_cap = LEAK_PAGES * PGSIZE / sizeof *table;
+  leaks = table;
+}
+
+/* Returns true if outstanding allocations are being tracked. */
+bool
+memleak_enabled (void)
+{
+  return leaks != NULL;
+}
+
+/* Records that BYTES at PTR were allocated by a call from
+   SITE. */
+void
+memleak_record (const void *ptr, size_t bytes, const void *site)
+{
+  enum intr_level old_level;
+  struct leak_rec *r;
+
+  if (leaks == NULL || ptr == NULL)
+    return;
+
+  old_level = intr_disable ();
+  if (leak_cnt < leak_cap - leak_cap / 8)
+    {
+      size_t i = leak_home (ptr);
+      while (leaks[i].ptr != NULL)
+        i = (i + 1) % leak_cap;
+      r = &leaks[i];
+      r->ptr = ptr;
+      r->site = site;
+      r->bytes = bytes;
+      leak_cnt++;
+    }
+  else
+    leak_dropped++;
+  intr_set_level (old_level);
+}
+
+/* Records that the allocation at PTR was freed. */
+void
+memleak_forget (const void *ptr)
+{
+  enum intr_level old_level;
+  struct leak_rec *r;
+
+  if (leaks == NULL || ptr == NULL)
+    return;
+
+  old_level = intr_disable ();
+  r = leak_find (ptr);
+  if (r != NULL)
+    {
+      /* Empty the slot, then move back any later entry whose
+         home slot does not lie between the hole and it. */
+      size_t hole = r - leaks;
+      size_t i = hole;
+
+      leaks[hole].ptr = NULL;
+      leak_cnt--;
+      for (;;)
+        {
+          size_t home;
+
+          i = (i + 1) % leak_cap;
+          if (leaks[i].ptr == NULL)
+            break;
+          home = leak_home (leaks[i].ptr);
+          if (hole <= i ? hole < home && home <= i : hole < home || home <= i)
+            continue;
+          leaks[hole] = leaks[i];
+          leaks[i].ptr = NULL;
+          hole = i;
+        }
+    }
+  intr_set_level (old_level);
+}
+
+/* Prints memory usage by tag, then the allocators' own
+   statistics, then outstanding allocations if tracking. */
+void
+mem_print_stats (void)
+{
+  int i;
+
+  for (i = 0; i < MEM_TAG_CNT; i++)
+    if (counters[i].peak > 0)
+      printf ("Memory %s: %zu kB in use, %zu kB peak\n", tag_names[i],
+              counters[i].bytes / 1024, counters[i].peak / 1024);
+  palloc_print_stats ();
+  malloc_print_stats ();
+  kmem_print_stats ();
+  if (leaks != NULL)
+    leak_report ();
+}
+
+/* Returns the slot where the probe for PTR starts. */
+static size_t
+leak_home (const void *ptr)
+{
+  return (uint32_t) ((uintptr_t) ptr >> 4) * 2654435761u % leak_cap;
+}
+
+/* Returns PTR's slot, or a null pointer if it is not in the
+   table.  Interrupts must be off. */
+static struct leak_rec *
+leak_find (const void *ptr)
+{
+  size_t i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  for (i = leak_home (ptr); leaks[i].ptr != NULL; i = (i + 1) % leak_cap)
+    if (leaks[i].ptr == ptr)
+      return &leaks[i];
+  return NULL;
+}
+
+/* Prints outstanding allocations, summed by call site. */
+static void
+leak_report (void)
+{
+  /* A call site's total. */
+  struct site_total
+    {
+      const void *site;
+      unsigned cnt;
+      size_t bytes;
+    };
+  static struct site_total sites[64];
+  size_t site_cnt = 0;
+  enum intr_level old_level;
+  size_t i, j;
+
+  old_level = intr_disable ();
+  for (i = 0; i < leak_cap; i++)
+    {
+      struct leak_rec *r = &leaks[i];
+      if (r->ptr == NULL)
+        continue;
+      for (j = 0; j < site_cnt; j++)
+        if (sites[j].site == r->site)
+          break;
+      if (j == site_cnt)
+        {
+          if (site_cnt == sizeof sites / sizeof *sites)
+            continue;
+          sites[site_cnt].site = r->site;
+          sites[site_cnt].cnt = 0;
+          sites[site_cnt].bytes = 0;
+          site_cnt++;
+        }
+      sites[j].cnt++;
+      sites[j].bytes += r->bytes;
+    }
+  intr_set_level (old_level);
+
+  for (j = 0; j < site_cnt; j++)
+    printf ("Leak from %p: %u allocations, %zu bytes\n",
+            sites[j].site, sites[j].cnt, sites[j].bytes);
+  if (leak_dropped > 0)
+    printf ("Leak tracking: %u allocations not tracked (table full)\n",
+            leak_dropped);
+}
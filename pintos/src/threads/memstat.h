@@ -0,0 +1,46 @@
+#ifndef THREADS_MEMSTAT_H
+#define THREADS_MEMSTAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Kernel memory accounting.
+
+   Every page handed out by the page allocator is charged to the
+   subsystem named by its tag, and live totals and high-water
+   marks are kept per tag.  malloc() and the object caches keep
+   their own finer-grained statistics on top of the pages they
+   are charged for.
+
+   With the -memleak option, every outstanding malloc() block, and
+   every page not owned by malloc() or an object cache, is also
+   remembered along with the address it was allocated from, so
+   that what is still live at shutdown can be reported by call
+   site.  Feed the addresses
+   to the `backtrace' tool to get function names. */
+
+/* What a page is used for. */
+enum mem_tag
+  {
+    MEM_OTHER,                  /* Anything not listed below. */
+    MEM_THREAD,                 /* Thread structures and kernel stacks. */
+    MEM_PAGEDIR,                /* Page directories and page tables. */
+    MEM_MALLOC,                 /* malloc() arenas and big blocks. */
+    MEM_SLAB,                   /* Object cache slabs. */
+    MEM_CACHE,                  /* Buffer cache. */
+    MEM_FRAME,                  /* User pages. */
+    MEM_PROCESS,                /* Per-process tables and arguments. */
+    MEM_TAG_CNT
+  };
+
+void memstat_alloc (enum mem_tag, size_t bytes);
+void memstat_free (enum mem_tag, size_t bytes);
+
+void memleak_init (void);
+bool memleak_enabled (void);
+void memleak_record (const void *, size_t bytes, const void *site);
+void memleak_forget (const void *);
+
+void mem_print_stats (void);
+
+#endif /* threads/memstat.h */
@@ -2,11 +2,13 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -23,25 +25,95 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   (addition) The pools no longer own fixed address ranges.  All
+   free memory forms one page arena, and a pool is a limit on how
+   many arena pages it may hold.  When a pool reaches its limit,
+   it borrows limit from the other pool, as long as the other
+   keeps at least an eighth of its own limit free and stays above
+   half of its initial share.  So a workload that thrashes user
+   frames through swap while the kernel pool sits idle gets more
+   frames, and the reverse, but neither side can be starved.
+   With -ul, the user pool never grows past the given size.
+
+   (addition) Within the arena, free pages are kept by a binary
+   buddy allocator.  Every free block is 2**ORDER pages long,
+   aligned to its own size relative to the arena base, and linked
+   into free_lists[ORDER] through a list_elem stored in its first
+   page.  Allocation takes the smallest block that fits and
+   splits it; freeing merges a block with its buddy for as long as
+   the buddy is free too, so both are O(log n) in the arena size
+   instead of the linear bitmap scan used before.  Requests that
+   are not a power of two give their unused tail back right away.
+   used_map still records which pages are handed out.
+
+   (addition) Single pages, by far the most common request, go
+   through a small per-pool magazine of recently freed pages in
+   front of the buddy lists.  The magazine is guarded only by
+   turning interrupts off for a few instructions; the arena lock
+   is taken just to refill or drain it MAG_BATCH pages at a time.
+   Pages sitting in a magazine stay marked in used_map and count
+   against their pool's limit. */
+
+/* Number of buddy orders: blocks of 1 to 2**(ORDER_CNT - 1)
+   pages. */ //addition
+#define ORDER_CNT 20
+
+/* ORDER_MAP entry for the first page of a free block. */ //addition
+#define ORDER_FREE 0x80
+
+/* TAG_MAP bit for pages that belong to the user pool. */ //addition
+#define TAG_USER 0x80
+
+/* Magazine capacity and refill/drain batch, in pages. */ //addition
+#define MAG_SIZE 32
+#define MAG_BATCH (MAG_SIZE / 2)
+
+/* Pages of limit moved between pools at a time, at least. */ //addition
+#define BALANCE_BATCH 16
 
 /* A memory pool. */
 struct pool
   {
-    struct lock lock;                   /* Mutual exclusion. */
-    struct bitmap *used_map;            /* Bitmap of free pages. */
-    uint8_t *base;                      /* Base of pool. */
+    const char *name;                   /* Name, for statistics. */
+    size_t limit;                       /* Pages this pool may hold. */
+    size_t limit_min;                   /* Never lend below this. */
+    size_t limit_max;                   /* Never borrow above this. */
+    size_t held;                        /* Pages held, magazine included. */
+    size_t used_cnt;                    /* Pages handed out. */
+    size_t used_peak;                   /* High-water mark of USED_CNT. */
+    size_t borrowed;                    /* Pages of limit ever borrowed. */
+    size_t mag_cnt;                     /* Pages in MAG. */
+    void *mag[MAG_SIZE];                /* Cached free pages. */
   };
 
 /* Two pools: one for kernel data, one for user pages. */
 static struct pool kernel_pool, user_pool;
-struct lock* get_user_pool_lock (void) {return &user_pool.lock;} //addition
-struct bitmap* get_user_pool_bitmap (void) {return user_pool.used_map;} //addition
-uint8_t* get_user_pool_base (void) {return user_pool.base;} //addition
 
-static void init_pool (struct pool *, void *base, size_t page_cnt,
+/* (addition) The page arena shared by both pools. */
+static struct lock arena_lock;          /* Mutual exclusion. */
+static struct bitmap *used_map;         /* Bitmap of used pages. */
+static uint8_t *arena_base;             /* Base of arena. */
+static uint8_t *order_map;              /* ORDER_FREE | order of the free
+                                           block starting at each page,
+                                           0 elsewhere. */
+static uint8_t *tag_map;                /* Memory tag of each used page,
+                                           | TAG_USER for the user pool. */
+static struct list free_lists[ORDER_CNT]; /* Free blocks by order. */
+
+static void init_arena (void *base, size_t page_cnt);
+static void init_pool (struct pool *, size_t limit, size_t limit_max,
                        const char *name);
-static bool page_from_pool (const struct pool *, void *page);
+static bool pool_reserve (struct pool *, size_t page_cnt);
+static struct pool *page_pool (size_t page_idx);
+static size_t buddy_alloc (size_t page_cnt);
+static void buddy_free (size_t page_idx, size_t page_cnt);
+static void *mag_get (struct pool *);
+static void mag_put (struct pool *, void *page);
+static void mag_drain (struct pool *, size_t page_cnt);
+static void *get_multiple (enum palloc_flags, size_t page_cnt,
+                           const void *site);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -52,16 +124,23 @@ palloc_init (size_t user_page_limit)
   uint8_t *free_start = ptov (1024 * 1024);
   uint8_t *free_end = ptov (init_ram_pages * PGSIZE);
   size_t free_pages = (free_end - free_start) / PGSIZE;
-  size_t user_pages = free_pages / 2;
-  size_t kernel_pages;
+  size_t user_pages, kernel_pages;
+
+  init_arena (free_start, free_pages);
+  free_pages = bitmap_size (used_map);
+  user_pages = free_pages / 2;
   if (user_pages > user_page_limit)
     user_pages = user_page_limit;
   kernel_pages = free_pages - user_pages;
 
-  /* Give half of memory to kernel, half to user. */
-  init_pool (&kernel_pool, free_start, kernel_pages, "kernel pool");
-  init_pool (&user_pool, free_start + kernel_pages * PGSIZE,
-             user_pages, "user pool");
+  /* Give half of memory to kernel, half to user.  Each pool may
+     borrow up to what the other must keep (addition). */
+  init_pool (&kernel_pool, kernel_pages, free_pages - user_pages / 2,
+             "kernel pool");
+  init_pool (&user_pool, user_pages, free_pages - kernel_pages / 2,
+             "user pool");
+  if (user_pool.limit_max > user_page_limit)
+    user_pool.limit_max = user_page_limit;
 }
 
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
@@ -72,28 +151,82 @@ palloc_init (size_t user_page_limit)
    FLAGS, in which case the kernel panics. */
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
+{
+  return get_multiple (flags, page_cnt, __builtin_return_address (0));
+}
+
+/* (addition) Does the work of palloc_get_multiple() on behalf of
+   a call from SITE. */
+static void *
+get_multiple (enum palloc_flags flags, size_t page_cnt, const void *site)
 {
   ASSERT ((flags & PAL_ASSERT) == 0 || (flags & PAL_USER) == 0);
   struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+  enum mem_tag tag = PAL_TAG_OF (flags);
   void *pages;
   size_t page_idx;
 
   if (page_cnt == 0)
     return NULL;
 
-  lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-  lock_release (&pool->lock);
-
-  if (page_idx != BITMAP_ERROR)
-    pages = pool->base + PGSIZE * page_idx;
+  if (page_cnt == 1)
+    pages = mag_get (pool); //addition
   else
-    pages = NULL;
+    {
+      lock_acquire (&arena_lock);
+      page_idx = BITMAP_ERROR;
+      if (!pool_reserve (pool, page_cnt))
+        {
+          /* Our own cached pages may be what keeps us at the
+             limit. */
+          mag_drain (pool, MAG_SIZE);
+          if (!pool_reserve (pool, page_cnt))
+            goto done;
+        }
+      page_idx = buddy_alloc (page_cnt); //addition
+      if (page_idx == BITMAP_ERROR)
+        {
+          /* Cached single pages may be what keeps a run from
+             forming; give them all back and try again. */
+          mag_drain (&kernel_pool, MAG_SIZE);
+          mag_drain (&user_pool, MAG_SIZE);
+          page_idx = buddy_alloc (page_cnt);
+          if (page_idx == BITMAP_ERROR)
+            pool->held -= page_cnt;
+        }
+      if (page_idx != BITMAP_ERROR)
+        bitmap_set_multiple (used_map, page_idx, page_cnt, true);
+    done:
+      lock_release (&arena_lock);
+
+      if (page_idx != BITMAP_ERROR)
+        pages = arena_base + PGSIZE * page_idx;
+      else
+        pages = NULL;
+    }
 
   if (pages != NULL) 
     {
+      enum intr_level old_level;
+
       if (flags & PAL_ZERO)
         memset (pages, 0, PGSIZE * page_cnt);
+
+      /* Account for the pages (addition). */
+      if (tag == MEM_OTHER && (flags & PAL_USER))
+        tag = MEM_FRAME;
+      ASSERT (tag < MEM_TAG_CNT);
+      page_idx = palloc_page_idx (pages);
+      memset (tag_map + page_idx, tag | (pool == &user_pool ? TAG_USER : 0),
+              page_cnt);
+      memstat_alloc (tag, PGSIZE * page_cnt);
+      if (tag != MEM_MALLOC && tag != MEM_SLAB)
+        memleak_record (pages, PGSIZE * page_cnt, site);
+      old_level = intr_disable ();
+      pool->used_cnt += page_cnt;
+      if (pool->used_cnt > pool->used_peak)
+        pool->used_peak = pool->used_cnt;
+      intr_set_level (old_level);
     }
   else 
     {
@@ -114,7 +247,7 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 void *
 palloc_get_page (enum palloc_flags flags) 
 {
-  return palloc_get_multiple (flags, 1);
+  return get_multiple (flags, 1, __builtin_return_address (0));
 }
 
 /* Frees the PAGE_CNT pages starting at PAGES. */
@@ -123,26 +256,44 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 {
   struct pool *pool;
   size_t page_idx;
+  enum intr_level old_level;
+  size_t i;
 
   ASSERT (pg_ofs (pages) == 0);
   if (pages == NULL || page_cnt == 0)
     return;
 
-  if (page_from_pool (&kernel_pool, pages))
-    pool = &kernel_pool;
-  else if (page_from_pool (&user_pool, pages))
-    pool = &user_pool;
-  else
-    NOT_REACHED ();
-
-  page_idx = pg_no (pages) - pg_no (pool->base);
+  page_idx = palloc_page_idx (pages);
+  pool = page_pool (page_idx);
 
 #ifndef NDEBUG
   memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
-  ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  ASSERT (bitmap_all (used_map, page_idx, page_cnt));
+
+  /* Account for the pages (addition). */
+  for (i = 0; i < page_cnt; i++)
+    {
+      ASSERT (page_pool (page_idx + i) == pool);
+      memstat_free (tag_map[page_idx + i] & ~TAG_USER, PGSIZE);
+    }
+  memleak_forget (pages);
+  old_level = intr_disable ();
+  pool->used_cnt -= page_cnt;
+  intr_set_level (old_level);
+
+  if (page_cnt == 1)
+    {
+      mag_put (pool, pages); //addition
+      return;
+    }
+
+  lock_acquire (&arena_lock);
+  bitmap_set_multiple (used_map, page_idx, page_cnt, false);
+  buddy_free (page_idx, page_cnt); //addition
+  pool->held -= page_cnt;
+  lock_release (&arena_lock);
 }
 
 /* Frees the page at PAGE. */
@@ -152,35 +303,360 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
-/* Initializes pool P as starting at START and ending at END,
-   naming it NAME for debugging purposes. */
+/* (addition) Returns the number of pages in the page arena.
+   Every page palloc_get_page() can return, from either pool, has
+   an index below this. */
+size_t
+palloc_page_cnt (void)
+{
+  return bitmap_size (used_map);
+}
+
+/* (addition) Returns the arena index of PAGE. */
+size_t
+palloc_page_idx (const void *page)
+{
+  size_t page_idx = pg_no (page) - pg_no (arena_base);
+  ASSERT (page_idx < bitmap_size (used_map));
+  return page_idx;
+}
+
+/* (addition) Returns the page at arena index PAGE_IDX. */
+void *
+palloc_page_addr (size_t page_idx)
+{
+  ASSERT (page_idx < bitmap_size (used_map));
+  return arena_base + PGSIZE * page_idx;
+}
+
+/* (addition) Returns the current size limit of the user pool. */
+size_t
+palloc_user_limit (void)
+{
+  return user_pool.limit;
+}
+
+/* (addition) Prints how many pages of each pool are in use. */
+void
+palloc_print_stats (void)
+{
+  struct pool *pools[] = {&kernel_pool, &user_pool};
+  size_t i;
+
+  for (i = 0; i < sizeof pools / sizeof *pools; i++)
+    {
+      struct pool *p = pools[i];
+      printf ("Palloc %s: %zu of %zu pages in use, %zu peak, "
+              "%zu borrowed\n", p->name, p->used_cnt, p->limit,
+              p->used_peak, p->borrowed);
+    }
+}
+
+/* (addition) Initializes the page arena as the PAGE_CNT pages
+   starting at BASE. */
 static void
-init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
+init_arena (void *base, size_t page_cnt) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  /* We'll put the arena's used_map at its base, followed by its
+     order_map and tag_map.  Calculate the space needed for all of
+     them and subtract it from the arena's size. */
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  size_t bm_pages = DIV_ROUND_UP (bm_size + 2 * page_cnt, PGSIZE);
+  int order;
   if (bm_pages > page_cnt)
-    PANIC ("Not enough memory in %s for bitmap.", name);
+    PANIC ("Not enough memory for page allocator bitmap.");
   page_cnt -= bm_pages;
 
-  printf ("%zu pages available in %s.\n", page_cnt, name);
+  /* Initialize the arena. */
+  lock_init (&arena_lock);
+  used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
+  order_map = (uint8_t *) base + bm_size;
+  memset (order_map, 0, page_cnt);
+  tag_map = order_map + page_cnt;
+  arena_base = (uint8_t *) base + bm_pages * PGSIZE;
+  for (order = 0; order < ORDER_CNT; order++)
+    list_init (&free_lists[order]);
+
+  /* Nothing is allocated yet, so the whole arena goes onto the
+     free lists as its largest aligned blocks. */
+  buddy_free (0, page_cnt);
+}
+
+/* Initializes pool P with an initial limit of LIMIT pages, which
+   may grow to LIMIT_MAX or shrink to half of LIMIT, naming it
+   NAME for debugging purposes. */
+static void
+init_pool (struct pool *p, size_t limit, size_t limit_max,
+           const char *name) 
+{
+  printf ("%zu pages available in %s.\n", limit, name);
+
+  p->name = name;
+  p->limit = limit;
+  p->limit_min = limit / 2;
+  p->limit_max = limit_max;
+  p->held = 0;
+  p->used_cnt = p->used_peak = 0;
+  p->borrowed = 0;
+  p->mag_cnt = 0;
+}
+
+/* (addition) Charges PAGE_CNT pages to POOL's limit, first
+   borrowing limit from the other pool if needed.  Returns false,
+   charging nothing, if that is not possible.  The arena lock
+   must be held. */
+static bool
+pool_reserve (struct pool *pool, size_t page_cnt)
+{
+  ASSERT (lock_held_by_current_thread (&arena_lock));
+
+  if (pool->held + page_cnt > pool->limit)
+    {
+      struct pool *other = pool == &user_pool ? &kernel_pool : &user_pool;
+      size_t need = pool->held + page_cnt - pool->limit;
+      size_t want = need > BALANCE_BATCH ? need : BALANCE_BATCH;
+      size_t watermark = other->limit / 8;
+      size_t spare;
+
+      /* The other pool keeps a free watermark and its minimum. */
+      spare = other->held + watermark < other->limit
+              ? other->limit - other->held - watermark : 0;
+      if (spare > other->limit - other->limit_min)
+        spare = other->limit - other->limit_min;
+      if (spare > pool->limit_max - pool->limit)
+        spare = pool->limit_max - pool->limit;
+      if (want > spare)
+        want = spare;
+      if (want < need)
+        return false;
 
-  /* Initialize the pool. */
-  lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
-  p->base = base + bm_pages * PGSIZE;
+      other->limit -= want;
+      pool->limit += want;
+      pool->borrowed += want;
+    }
+
+  pool->held += page_cnt;
+  return true;
+}
+
+/* (addition) Returns the pool that used page PAGE_IDX belongs
+   to. */
+static struct pool *
+page_pool (size_t page_idx)
+{
+  return tag_map[page_idx] & TAG_USER ? &user_pool : &kernel_pool;
+}
+
+/* (addition) Returns the address of the free block node at page
+   PAGE_IDX. */
+static struct list_elem *
+block_elem (size_t page_idx)
+{
+  return (struct list_elem *) (arena_base + PGSIZE * page_idx);
 }
 
-/* Returns true if PAGE was allocated from POOL,
-   false otherwise. */
+/* (addition) Adds the free block of 2**ORDER pages at PAGE_IDX to
+   the free lists. */
+static void
+block_push (size_t page_idx, int order)
+{
+  order_map[page_idx] = ORDER_FREE | order;
+  list_push_front (&free_lists[order], block_elem (page_idx));
+}
+
+/* (addition) Returns the smallest order whose blocks hold at least
+   PAGE_CNT pages, or ORDER_CNT if there is none. */
+static int
+order_for (size_t page_cnt)
+{
+  int order = 0;
+  while (order < ORDER_CNT && ((size_t) 1 << order) < page_cnt)
+    order++;
+  return order;
+}
+
+/* (addition) Takes PAGE_CNT contiguous pages off the free lists
+   and returns the index of the first one, or BITMAP_ERROR if no
+   free block is large enough.  The arena lock must be held. */
+static size_t
+buddy_alloc (size_t page_cnt)
+{
+  int want = order_for (page_cnt);
+  int order;
+  size_t page_idx;
+
+  for (order = want; order < ORDER_CNT; order++)
+    if (!list_empty (&free_lists[order]))
+      break;
+  if (order >= ORDER_CNT)
+    return BITMAP_ERROR;
+
+  page_idx = (pg_no (list_pop_front (&free_lists[order]))
+              - pg_no (arena_base));
+  order_map[page_idx] = 0;
+
+  /* Split off upper halves until the block is the size wanted. */
+  while (order > want)
+    {
+      order--;
+      block_push (page_idx + ((size_t) 1 << order), order);
+    }
+
+  /* Give back whatever rounding up to a power of two added. */
+  if (page_cnt < (size_t) 1 << want)
+    buddy_free (page_idx + page_cnt, ((size_t) 1 << want) - page_cnt);
+
+  return page_idx;
+}
+
+/* (addition) Returns the PAGE_CNT pages starting at PAGE_IDX to
+   the free lists, merging each aligned block with its buddy while
+   the buddy is free.  The arena lock must be held, except during
+   initialization. */
+static void
+buddy_free (size_t page_idx, size_t page_cnt)
+{
+  size_t arena_size = bitmap_size (used_map);
+
+  while (page_cnt > 0)
+    {
+      /* Largest aligned block that starts at PAGE_IDX and fits. */
+      int order = 0;
+      size_t block_idx = page_idx;
+      size_t size;
+
+      while (order + 1 < ORDER_CNT
+             && (page_idx & (((size_t) 1 << (order + 1)) - 1)) == 0
+             && ((size_t) 1 << (order + 1)) <= page_cnt)
+        order++;
+      size = (size_t) 1 << order;
+      page_idx += size;
+      page_cnt -= size;
+
+      /* Merge with free buddies. */
+      while (order + 1 < ORDER_CNT)
+        {
+          size_t buddy_idx = block_idx ^ ((size_t) 1 << order);
+          if (buddy_idx + ((size_t) 1 << order) > arena_size
+              || order_map[buddy_idx] != (ORDER_FREE | order))
+            break;
+          list_remove (block_elem (buddy_idx));
+          order_map[buddy_idx] = 0;
+          if (buddy_idx < block_idx)
+            block_idx = buddy_idx;
+          order++;
+        }
+      block_push (block_idx, order);
+    }
+}
+
+/* (addition) Pushes PAGE onto POOL's magazine.  Returns false,
+   without pushing, if the magazine is full. */
 static bool
-page_from_pool (const struct pool *pool, void *page) 
+mag_push (struct pool *pool, void *page)
+{
+  enum intr_level old_level = intr_disable ();
+  bool pushed = pool->mag_cnt < MAG_SIZE;
+  if (pushed)
+    pool->mag[pool->mag_cnt++] = page;
+  intr_set_level (old_level);
+  return pushed;
+}
+
+/* (addition) Pops a page off POOL's magazine, or returns a null
+   pointer if it is empty. */
+static void *
+mag_pop (struct pool *pool)
+{
+  enum intr_level old_level = intr_disable ();
+  void *page = pool->mag_cnt > 0 ? pool->mag[--pool->mag_cnt] : NULL;
+  intr_set_level (old_level);
+  return page;
+}
+
+/* (addition) Returns single PAGE held by POOL to the buddy lists.
+   The arena lock must be held. */
+static void
+mag_release (struct pool *pool, void *page)
+{
+  size_t page_idx = palloc_page_idx (page);
+  bitmap_reset (used_map, page_idx);
+  buddy_free (page_idx, 1);
+  pool->held--;
+}
+
+/* (addition) Returns a free page from POOL, refilling POOL's
+   magazine with up to MAG_BATCH pages from the buddy lists when
+   it runs dry.  Returns a null pointer if the pool is out of
+   pages. */
+static void *
+mag_get (struct pool *pool)
+{
+  void *page = mag_pop (pool);
+  size_t i;
+
+  if (page != NULL)
+    return page;
+
+  lock_acquire (&arena_lock);
+  for (i = 0; i < MAG_BATCH; i++)
+    {
+      size_t page_idx;
+      void *p;
+
+      if (!pool_reserve (pool, 1))
+        break;
+      page_idx = buddy_alloc (1);
+      if (page_idx == BITMAP_ERROR && page == NULL)
+        {
+          /* The other pool's magazine may hold the last pages. */
+          mag_drain (pool == &user_pool ? &kernel_pool : &user_pool,
+                     MAG_SIZE);
+          page_idx = buddy_alloc (1);
+        }
+      if (page_idx == BITMAP_ERROR)
+        {
+          pool->held--;
+          break;
+        }
+      bitmap_mark (used_map, page_idx);
+      p = arena_base + PGSIZE * page_idx;
+      if (page == NULL)
+        page = p;
+      else if (!mag_push (pool, p))
+        {
+          /* Refilled behind our back by concurrent frees. */
+          mag_release (pool, p);
+          break;
+        }
+    }
+  lock_release (&arena_lock);
+
+  return page;
+}
+
+/* (addition) Caches free PAGE in POOL's magazine.  If the
+   magazine is full, PAGE and MAG_BATCH cached pages go back to
+   the buddy lists instead. */
+static void
+mag_put (struct pool *pool, void *page)
+{
+  if (mag_push (pool, page))
+    return;
+
+  lock_acquire (&arena_lock);
+  mag_release (pool, page);
+  mag_drain (pool, MAG_BATCH);
+  lock_release (&arena_lock);
+}
+
+/* (addition) Returns up to PAGE_CNT pages from POOL's magazine to
+   the buddy lists.  The arena lock must be held. */
+static void
+mag_drain (struct pool *pool, size_t page_cnt)
 {
-  size_t page_no = pg_no (page);
-  size_t start_page = pg_no (pool->base);
-  size_t end_page = start_page + bitmap_size (pool->used_map);
+  void *page;
 
-  return page_no >= start_page && page_no < end_page;
+  while (page_cnt-- > 0 && (page = mag_pop (pool)) != NULL)
+    mag_release (pool, page);
 }
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include "threads/synch.h" //addition
 #include "lib/kernel/bitmap.h" //addition
+#include "threads/memstat.h" //addition
 
 /* How to allocate pages. */
 enum palloc_flags
@@ -13,14 +14,22 @@ enum palloc_flags
     PAL_USER = 004              /* User page. */
   };
 
+/* (addition) Charges the pages to memory tag TAG, an enum
+   mem_tag.  User pages default to MEM_FRAME, others to
+   MEM_OTHER. */
+#define PAL_TAG(TAG) ((enum palloc_flags) ((TAG) << 4))
+#define PAL_TAG_OF(FLAGS) ((enum mem_tag) ((FLAGS) >> 4))
+
 void palloc_init (size_t user_page_limit);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+void palloc_print_stats (void); //addition
 
-struct lock* get_user_pool_lock (void); //addition
-struct bitmap* get_user_pool_bitmap (void); //addition
-uint8_t* get_user_pool_base (void); //addition
+size_t palloc_page_cnt (void); //addition
+size_t palloc_page_idx (const void *); //addition
+void *palloc_page_addr (size_t); //addition
+size_t palloc_user_limit (void); //addition
 
 #endif /* threads/palloc.h */
@@ -0,0 +1,292 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator.
+
+   Each slab is one page.  The page starts with a `struct slab'
+   header, followed by a stack of the indexes of its free objects,
+   followed by the objects themselves.  Free objects are tracked
+   outside the objects so that constructed state survives a trip
+   through the free list.
+
+   A cache keeps its slabs on two lists, those with free objects
+   and those without, and allocates from the first slab with a
+   free object.  A slab whose objects are all free is kept as the
+   cache's spare if it has none yet and returned to the page
+   allocator otherwise, so a cache bouncing between 0 and 1
+   objects does not hit palloc every time. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* An object cache. */
+struct kmem_cache
+  {
+    const char *name;           /* Name, for statistics. */
+    size_t obj_size;            /* Object size in bytes. */
+    size_t objs_per_slab;       /* Number of objects per slab. */
+    size_t objs_ofs;            /* Offset of first object in a slab. */
+    kmem_ctor *ctor;            /* Constructor, or null. */
+    struct lock lock;           /* Protects everything below. */
+    struct list partial;        /* Slabs with free objects. */
+    struct list full;           /* Slabs without free objects. */
+    struct slab *spare;         /* An entirely free slab, or null. */
+    struct list_elem elem;      /* Element in all_caches. */
+
+    /* Statistics. */
+    uint64_t alloc_cnt;         /* Allocations ever made. */
+    unsigned active;            /* Objects currently allocated. */
+    unsigned active_max;        /* High-water mark of ACTIVE. */
+    unsigned slab_cnt;          /* Slabs currently owned. */
+  };
+
+/* Slab header, at the start of each slab's page. */
+struct slab
+  {
+    unsigned magic;             /* Always set to SLAB_MAGIC. */
+    struct kmem_cache *cache;   /* Owning cache. */
+    struct list_elem elem;      /* Element in partial or full list. */
+    size_t free_cnt;            /* Number of free objects. */
+    uint16_t free_idx[];        /* Indexes of free objects. */
+  };
+
+/* All caches, for kmem_print_stats(). */
+static struct list all_caches = LIST_INITIALIZER (all_caches);
+
+static struct slab *slab_create (struct kmem_cache *);
+static struct slab *obj_to_slab (struct kmem_cache *, void *);
+static void *slab_obj (struct kmem_cache *, struct slab *, size_t idx);
+
+/* Creates and returns a cache of SIZE-byte objects named NAME,
+   calling CTOR, if nonnull, on each object when its slab is
+   created.  Panics if memory is not available, since caches are
+   created at initialization time. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, kmem_ctor *ctor)
+{
+  struct kmem_cache *c;
+  size_t per_slab;
+  enum intr_level old_level;
+
+  ASSERT (name != NULL);
+  ASSERT (size > 0);
+
+  c = malloc (sizeof *c);
+  if (c == NULL)
+    PANIC ("kmem_cache_create: out of memory for cache %s", name);
+
+  /* Objects are word-aligned.  Each one costs its size plus a
+     free index; shrink the count until the header, the index
+     stack and the aligned objects fit in a page. */
+  size = ROUND_UP (size, sizeof (void *));
+  per_slab = (PGSIZE - sizeof (struct slab)) / (size + sizeof (uint16_t));
+  while (per_slab > 0
+         && (ROUND_UP (sizeof (struct slab) + per_slab * sizeof (uint16_t),
+                       sizeof (void *))
+             + per_slab * size) > PGSIZE)
+    per_slab--;
+  ASSERT (per_slab > 0);
+
+  c->name = name;
+  c->obj_size = size;
+  c->objs_per_slab = per_slab;
+  c->objs_ofs = ROUND_UP (sizeof (struct slab) + per_slab * sizeof (uint16_t),
+                          sizeof (void *));
+  c->ctor = ctor;
+  lock_init (&c->lock);
+  list_init (&c->partial);
+  list_init (&c->full);
+  c->spare = NULL;
+  c->alloc_cnt = 0;
+  c->active = c->active_max = c->slab_cnt = 0;
+
+  old_level = intr_disable ();
+  list_push_back (&all_caches, &c->elem);
+  intr_set_level (old_level);
+
+  return c;
+}
+
+/* Obtains and returns an object from cache C.
+   Returns a null pointer if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *c)
+{
+  struct slab *s;
+  void *obj;
+
+  lock_acquire (&c->lock);
+  if (list_empty (&c->partial))
+    {
+      if (c->spare != NULL)
+        {
+          s = c->spare;
+          c->spare = NULL;
+        }
+      else
+        {
+          s = slab_create (c);
+          if (s == NULL)
+            {
+              lock_release (&c->lock);
+              return NULL;
+            }
+        }
+      list_push_front (&c->partial, &s->elem);
+    }
+
+  s = list_entry (list_front (&c->partial), struct slab, elem);
+  obj = slab_obj (c, s, s->free_idx[--s->free_cnt]);
+  if (s->free_cnt == 0)
+    {
+      list_remove (&s->elem);
+      list_push_front (&c->full, &s->elem);
+    }
+
+  c->alloc_cnt++;
+  if (++c->active > c->active_max)
+    c->active_max = c->active;
+  lock_release (&c->lock);
+
+  return obj;
+}
+
+/* Like kmem_cache_alloc(), but zeroes the object.  Only
+   meaningful for caches without a constructor. */
+void *
+kmem_cache_zalloc (struct kmem_cache *c)
+{
+  void *obj;
+
+  ASSERT (c->ctor == NULL);
+  obj = kmem_cache_alloc (c);
+  if (obj != NULL)
+    memset (obj, 0, c->obj_size);
+  return obj;
+}
+
+/* Returns OBJ, which must have been obtained from cache C, to
+   C.  A null OBJ is ignored. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj)
+{
+  struct slab *s;
+  size_t idx;
+
+  if (obj == NULL)
+    return;
+
+  s = obj_to_slab (c, obj);
+  idx = ((uint8_t *) obj - (uint8_t *) s - c->objs_ofs) / c->obj_size;
+
+#ifndef NDEBUG
+  /* Clear the object to help detect use-after-free bugs, unless
+     that would destroy its constructed state. */
+  if (c->ctor == NULL)
+    memset (obj, 0xcc, c->obj_size);
+#endif
+
+  lock_acquire (&c->lock);
+  ASSERT (s->free_cnt < c->objs_per_slab);
+  if (s->free_cnt == 0)
+    {
+      list_remove (&s->elem);
+      list_push_front (&c->partial, &s->elem);
+    }
+  s->free_idx[s->free_cnt++] = idx;
+  c->active--;
+
+  if (s->free_cnt == c->objs_per_slab)
+    {
+      list_remove (&s->elem);
+      if (c->spare == NULL)
+        c->spare = s;
+      else
+        {
+          s->magic = 0;
+          c->slab_cnt--;
+          palloc_free_page (s);
+        }
+    }
+  lock_release (&c->lock);
+}
+
+/* Prints statistics for every cache that has been used. */
+void
+kmem_print_stats (void)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&all_caches); e != list_end (&all_caches);
+       e = list_next (e))
+    {
+      struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+      if (c->alloc_cnt > 0)
+        printf ("Slab %s: %zu-byte objects, %"PRIu64" allocated, "
+                "%u active (%u peak), %u slabs\n",
+                c->name, c->obj_size, c->alloc_cnt,
+                c->active, c->active_max, c->slab_cnt);
+    }
+}
+
+/* Obtains a page for a new slab of cache C and constructs its
+   objects.  Returns a null pointer if no page is available. */
+static struct slab *
+slab_create (struct kmem_cache *c)
+{
+  struct slab *s = palloc_get_page (PAL_TAG (MEM_SLAB));
+  size_t i;
+
+  if (s == NULL)
+    return NULL;
+
+  s->magic = SLAB_MAGIC;
+  s->cache = c;
+  s->free_cnt = c->objs_per_slab;
+  for (i = 0; i < c->objs_per_slab; i++)
+    {
+      /* Hand out low addresses first. */
+      s->free_idx[i] = c->objs_per_slab - 1 - i;
+      if (c->ctor != NULL)
+        c->ctor (slab_obj (c, s, i));
+    }
+  c->slab_cnt++;
+  return s;
+}
+
+/* Returns the slab of cache C that OBJ is inside. */
+static struct slab *
+obj_to_slab (struct kmem_cache *c, void *obj)
+{
+  struct slab *s = pg_round_down (obj);
+
+  /* Check that the slab is valid. */
+  ASSERT (s != NULL);
+  ASSERT (s->magic == SLAB_MAGIC);
+  ASSERT (s->cache == c);
+
+  /* Check that the object is properly aligned for the slab. */
+  ASSERT (pg_ofs (obj) >= c->objs_ofs);
+  ASSERT ((pg_ofs (obj) - c->objs_ofs) % c->obj_size == 0);
+
+  return s;
+}
+
+/* Returns the IDX'th object in slab S of cache C. */
+static void *
+slab_obj (struct kmem_cache *c, struct slab *s, size_t idx)
+{
+  ASSERT (idx < c->objs_per_slab);
+  return (uint8_t *) s + c->objs_ofs + idx * c->obj_size;
+}
@@ -0,0 +1,29 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <stddef.h>
+
+/* Object caches.
+
+   A cache hands out objects of a single, exact size, carved out
+   of page-sized slabs obtained from the page allocator.  Hot
+   fixed-size kernel objects use a cache instead of malloc() to
+   avoid rounding up to a power of 2 and to keep allocation and
+   freeing to a few instructions under the cache's lock.
+
+   If a cache has a constructor, it is called once for each object
+   when its slab is created, not on every allocation.  Objects
+   must therefore be returned to the cache in their constructed
+   state, which lets a cache of locks skip reinitializing them. */
+
+struct kmem_cache;
+typedef void kmem_ctor (void *);
+
+struct kmem_cache *kmem_cache_create (const char *name, size_t size,
+                                      kmem_ctor *);
+void *kmem_cache_alloc (struct kmem_cache *);
+void *kmem_cache_zalloc (struct kmem_cache *);
+void kmem_cache_free (struct kmem_cache *, void *);
+void kmem_print_stats (void);
+
+#endif /* threads/slab.h */
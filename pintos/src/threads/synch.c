@@ -27,10 +27,19 @@
 */
 
 #include "threads/synch.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Lock classes (addition). */
+#define LOCK_CLASS_CNT 64
+static struct lock_class lock_classes[LOCK_CLASS_CNT];
+static size_t lock_class_cnt;
+
+static struct lock_class *lock_class_lookup (const char *name);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -114,10 +123,17 @@ sema_up (struct semaphore *sema)
 
   old_level = intr_disable ();
   if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
+    {
+      /* Wake the highest-priority waiter (addition). */
+      struct list_elem *e = list_max (&sema->waiters,
+                                      thread_less_priority, NULL);
+      list_remove (e);
+      thread_unblock (list_entry (e, struct thread, elem));
+    }
   sema->value++;
   intr_set_level (old_level);
+
+  thread_preempt (); //addition
 }
 
 static void sema_test_helper (void *sema_);
@@ -171,14 +187,55 @@ sema_test_helper (void *sema_)
    another one "up" it, but with a lock the same thread must both
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
+   instead of a lock.
+
+   Locks are normally initialized through the lock_init() macro,
+   which passes the text of its argument as NAME.  Contention
+   statistics are kept per NAME and printed at shutdown by
+   lock_print_stats(). */
 void
-lock_init (struct lock *lock)
+lock_init_named (struct lock *lock, const char *name)
 {
   ASSERT (lock != NULL);
+  ASSERT (name != NULL);
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+  lock->class = lock_class_lookup (name);
+  lock->acquire_time = 0;
+}
+
+/* Returns the lock class named NAME, creating it if needed.
+   When the table is full, further names share its last slot. */
+static struct lock_class *
+lock_class_lookup (const char *name)
+{
+  enum intr_level old_level;
+  struct lock_class *c;
+  size_t i;
+
+  /* Skip the `&' of "&foo_lock" for readability. */
+  if (*name == '&')
+    name++;
+
+  old_level = intr_disable ();
+  for (i = 0; i < lock_class_cnt; i++)
+    if (lock_classes[i].name == name || !strcmp (lock_classes[i].name, name))
+      break;
+  if (i == lock_class_cnt)
+    {
+      if (lock_class_cnt < LOCK_CLASS_CNT)
+        lock_classes[lock_class_cnt++].name = name;
+      else
+        {
+          i = LOCK_CLASS_CNT - 1;
+          lock_classes[i].name = "(other)";
+        }
+    }
+  c = &lock_classes[i];
+  intr_set_level (old_level);
+
+  return c;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -192,12 +249,46 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  old_level = intr_disable ();
+  lock->class->acquired++;
+  if (lock->semaphore.value > 0)
+    {
+      lock->semaphore.value--;
+      lock->holder = cur;
+      list_push_back (&cur->held_locks, &lock->elem);
+    }
+  else
+    {
+      int64_t start = timer_ticks ();
+
+      /* Lend our priority to the holder, and down the chain of
+         locks it is waiting for, so it cannot be starved by
+         threads of intermediate priority while we wait
+         (addition). */
+      if (!thread_mlfqs)
+        {
+          cur->waiting_lock = lock;
+          thread_donate_priority (lock->holder, cur->priority);
+        }
+
+      /* lock_release() hands the lock straight to the waiter it
+         wakes, so there is no race to re-take it. */
+      list_push_back (&lock->semaphore.waiters, &cur->elem);
+      thread_block ();
+      ASSERT (lock->holder == cur);
+
+      lock->class->contended++;
+      lock->class->wait_ticks += timer_ticks () - start;
+    }
+  lock->acquire_time = timer_ticks ();
+  intr_set_level (old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -209,14 +300,22 @@ lock_acquire (struct lock *lock)
 bool
 lock_try_acquire (struct lock *lock)
 {
+  enum intr_level old_level;
   bool success;
 
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      lock->holder = thread_current ();
+      list_push_back (&thread_current ()->held_locks, &lock->elem); //addition
+      lock->class->acquired++;
+      lock->acquire_time = timer_ticks ();
+    }
+  intr_set_level (old_level);
   return success;
 }
 
@@ -228,11 +327,47 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock) 
 {
+  enum intr_level old_level;
+  int64_t hold;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  lock->holder = NULL;
-  sema_up (&lock->semaphore);
+  old_level = intr_disable ();
+  hold = timer_ticks () - lock->acquire_time;
+  if (hold > lock->class->max_hold_ticks)
+    lock->class->max_hold_ticks = hold;
+
+  list_remove (&lock->elem);
+  if (!list_empty (&lock->semaphore.waiters))
+    {
+      /* Hand the lock directly to the highest-priority waiter,
+         which then inherits the donations of those still
+         waiting (addition). */
+      struct list_elem *e = list_max (&lock->semaphore.waiters,
+                                      thread_less_priority, NULL);
+      struct thread *t = list_entry (e, struct thread, elem);
+
+      list_remove (e);
+      lock->holder = t;
+      t->waiting_lock = NULL;
+      list_push_back (&t->held_locks, &lock->elem);
+      if (!thread_mlfqs)
+        thread_refresh_priority (t);
+      thread_unblock (t);
+    }
+  else
+    {
+      lock->holder = NULL;
+      lock->semaphore.value++;
+    }
+
+  /* Give back any priority donated through this lock. */
+  if (!thread_mlfqs)
+    thread_refresh_priority (thread_current ());
+  intr_set_level (old_level);
+
+  thread_preempt ();
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -245,14 +380,45 @@ lock_held_by_current_thread (const struct lock *lock)
 
   return lock->holder == thread_current ();
 }
+
+/* Prints contention statistics for each lock class that ever
+   had to wait. */
+void
+lock_print_stats (void) 
+{
+  size_t i;
+
+  for (i = 0; i < lock_class_cnt; i++)
+    {
+      struct lock_class *c = &lock_classes[i];
+      if (c->contended > 0)
+        printf ("Lock %s: %u acquired, %u contended, "
+                "%"PRId64" ticks waited, %"PRId64" ticks max hold\n",
+                c->name, c->acquired, c->contended,
+                c->wait_ticks, c->max_hold_ticks);
+    }
+}
 
 /* One semaphore in a list. */
 struct semaphore_elem 
   {
     struct list_elem elem;              /* List element. */
     struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Waiting thread (addition). */
   };
 
+/* Returns true if the thread waiting on semaphore_elem A has a
+   lower priority than the one waiting on B (addition). */
+static bool
+sema_elem_less_priority (const struct list_elem *a_,
+                         const struct list_elem *b_, void *aux UNUSED)
+{
+  const struct semaphore_elem *a = list_entry (a_, struct semaphore_elem, elem);
+  const struct semaphore_elem *b = list_entry (b_, struct semaphore_elem, elem);
+
+  return a->thread->priority < b->thread->priority;
+}
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -295,6 +461,7 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current (); //addition
   list_push_back (&cond->waiters, &waiter.elem);
   lock_release (lock);
   sema_down (&waiter.semaphore);
@@ -317,8 +484,13 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (lock_held_by_current_thread (lock));
 
   if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+    {
+      /* Signal the highest-priority waiter (addition). */
+      struct list_elem *e = list_max (&cond->waiters,
+                                      sema_elem_less_priority, NULL);
+      list_remove (e);
+      sema_up (&list_entry (e, struct semaphore_elem, elem)->semaphore);
+    }
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -336,3 +508,118 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes RWLOCK.  A reader-writer lock may be held by any
+   number of readers at once, or by a single writer.
+
+   It is fair to both sides.  Once a writer is waiting, newly
+   arriving readers queue behind it instead of joining the
+   readers already inside, so a stream of readers cannot starve
+   writers.  When a writer releases the lock, every reader that
+   queued meanwhile is let in as one batch ahead of the next
+   writer, so a stream of writers cannot starve readers either.
+
+   Like a lock, a reader-writer lock is not recursive.  Its
+   contention statistics are kept under NAME, which the
+   rwlock_init() macro fills in like lock_init() does. */
+void
+rwlock_init_named (struct rwlock *rw, const char *name) 
+{
+  ASSERT (rw != NULL);
+
+  lock_init_named (&rw->lock, name);
+  cond_init (&rw->can_read);
+  cond_init (&rw->can_write);
+  rw->readers = 0;
+  rw->readers_waiting = 0;
+  rw->writers_waiting = 0;
+  rw->read_turn = 0;
+  rw->writer = NULL;
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   is waiting for it. */
+void
+rwlock_acquire_read (struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_write_held_by_current_thread (rw));
+
+  lock_acquire (&rw->lock);
+  if (rw->writer != NULL || rw->writers_waiting > 0)
+    {
+      /* Wait for the writer that releases next to let us in.
+         It counts us into READERS on our behalf. */
+      unsigned turn = rw->read_turn;
+      rw->readers_waiting++;
+      while (turn == rw->read_turn)
+        cond_wait (&rw->can_read, &rw->lock);
+    }
+  else
+    rw->readers++;
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for
+   reading. */
+void
+rwlock_release_read (struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->readers > 0);
+  if (--rw->readers == 0 && rw->writers_waiting > 0)
+    cond_signal (&rw->can_write, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it at all. */
+void
+rwlock_acquire_write (struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_write_held_by_current_thread (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writers_waiting++;
+  while (rw->writer != NULL || rw->readers > 0)
+    cond_wait (&rw->can_write, &rw->lock);
+  rw->writers_waiting--;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for writing.
+   Readers that queued while it was held go first. */
+void
+rwlock_release_write (struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_write_held_by_current_thread (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writer = NULL;
+  if (rw->readers_waiting > 0)
+    {
+      rw->readers += rw->readers_waiting;
+      rw->readers_waiting = 0;
+      rw->read_turn++;
+      cond_broadcast (&rw->can_read, &rw->lock);
+    }
+  else if (rw->writers_waiting > 0)
+    cond_signal (&rw->can_write, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing. */
+bool
+rwlock_write_held_by_current_thread (const struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
@@ -3,6 +3,7 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore 
@@ -17,18 +18,36 @@ bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
+/* Contention statistics, shared by every lock initialized at the
+   same lock_init() call site and named after its argument. */
+struct lock_class 
+  {
+    const char *name;           /* Argument text of lock_init(). */
+    unsigned acquired;          /* # of acquisitions. */
+    unsigned contended;         /* # of acquisitions that had to wait. */
+    int64_t wait_ticks;         /* Total timer ticks spent waiting. */
+    int64_t max_hold_ticks;     /* Longest time held, in timer ticks. */
+  };
+
 /* Lock. */
 struct lock 
   {
     struct thread *holder;      /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct list_elem elem;      /* (addition) element in holder's held_locks */
+    struct lock_class *class;   /* (addition) contention statistics */
+    int64_t acquire_time;       /* (addition) tick at which holder got it */
   };
 
-void lock_init (struct lock *);
+/* Names each lock after the expression that initializes it, so
+   that, e.g., lock_init (&ft_lock) reports as "ft_lock". */
+#define lock_init(LOCK) lock_init_named (LOCK, #LOCK)
+void lock_init_named (struct lock *, const char *name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+void lock_print_stats (void);
 
 /* Condition variable. */
 struct condition 
@@ -41,6 +60,27 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Reader-writer lock. */
+struct rwlock 
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition can_read;  /* Signaled when readers are let in. */
+    struct condition can_write; /* Signaled when a writer may enter. */
+    int readers;                /* # of readers inside (or let in). */
+    int readers_waiting;        /* # of readers waiting for a turn. */
+    int writers_waiting;        /* # of writers waiting. */
+    unsigned read_turn;         /* Bumped each time waiting readers are let in. */
+    struct thread *writer;      /* Thread holding it for writing, if any. */
+  };
+
+#define rwlock_init(RWLOCK) rwlock_init_named (RWLOCK, #RWLOCK)
+void rwlock_init_named (struct rwlock *, const char *name);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_write_held_by_current_thread (const struct rwlock *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
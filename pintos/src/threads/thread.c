@@ -7,11 +7,14 @@
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #ifdef USERPROG
+#include <console.h>
 #include "userprog/process.h"
 #endif
 #ifdef FILESYS
@@ -25,10 +28,20 @@ int counter = 0; // counter for fd allocation
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-static struct list sleep_list; //addition for alarm clock
+/* Processes in THREAD_READY state, that is, processes that are
+   ready to run but not actually running.  There is one FIFO list
+   per priority, and bit P of ready_mask is set exactly when
+   ready_list[P] is non-empty, so the highest-priority ready
+   thread is found with a find-last-set instead of a list walk. */
+static struct list ready_list[PRI_MAX + 1];
+static uint64_t ready_mask;
+static int ready_cnt;           /* Number of threads in ready_list[]. */
+/* Sleeping threads, as a pairing heap ordered by alarm_ticks
+   and linked through sleep_child/sleep_sibling (addition for
+   alarm clock).  Insertion is O(1) and the next deadline is
+   always at the root, so the timer interrupt checks it in O(1);
+   removing the root costs amortized O(log n). */
+static struct thread *sleep_root;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
@@ -53,18 +66,31 @@ struct kernel_thread_frame
 
 /* Statistics. */
 static long long idle_ticks;    /* # of timer ticks spent idle. */
-static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
-static long long user_ticks;    /* # of timer ticks in user programs. */
+static long long kernel_ticks;  /* # of timer ticks in kernel mode. */
+static long long user_ticks;    /* # of timer ticks in user mode. */
+static long long vol_switches;  /* # of switches away from a thread that blocked. */
+static long long invol_switches; /* # of switches away from a preempted thread. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
+#define TIME_SLICE 4            /* Default # of timer ticks to give each thread. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
+/* # of timer ticks to give a thread in each priority band, lowest
+   band first.  Set with the "-slice" kernel command-line option:
+   longer slices for low bands favor throughput of batch work,
+   shorter ones for high bands favor latency. */
+static unsigned time_slice[PRI_BAND_CNT] =
+  { TIME_SLICE, TIME_SLICE, TIME_SLICE, TIME_SLICE };
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* System load average, for the -mlfqs scheduler: an estimate of
+   the number of threads ready to run over the past minute. */
+static fixed_t load_avg;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -77,7 +103,14 @@ static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
 
-static bool thread_less_alarm_ticks (const struct list_elem*, const struct list_elem*, void*); //addition for alarm clock
+static struct thread* sleep_meld (struct thread*, struct thread*); //addition for alarm clock
+static struct thread* sleep_merge_pairs (struct thread*); //addition for alarm clock
+static void ready_push (struct thread *);
+static void ready_remove (struct thread *);
+static void thread_change_priority (struct thread *, int priority);
+static int mlfqs_priority (const struct thread *);
+static void mlfqs_update_second (void);
+static int ready_max_priority (void);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -95,11 +128,16 @@ static bool thread_less_alarm_ticks (const struct list_elem*, const struct list_
 void
 thread_init (void) 
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
-  list_init (&sleep_list); //addition for alarm clock
+  for (i = PRI_MIN; i <= PRI_MAX; i++)
+    list_init (&ready_list[i]);
+  ready_mask = 0;
+  ready_cnt = 0;
+  sleep_root = NULL; //addition for alarm clock
   list_init (&all_list);
 
   /* Set up a thread structure for the running thread. */
@@ -127,33 +165,126 @@ thread_start (void)
 }
 
 /* Called by the timer interrupt handler at each timer tick.
-   Thus, this function runs in an external interrupt context. */
+   USER is true if the tick interrupted user-mode code.  Thus,
+   this function runs in an external interrupt context. */
 void
-thread_tick (void) 
+thread_tick (bool user) 
 {
   struct thread *t = thread_current ();
 
   /* Update statistics. */
   if (t == idle_thread)
     idle_ticks++;
-#ifdef USERPROG
-  else if (t->pagedir != NULL)
+  else if (user)
     user_ticks++;
-#endif
   else
     kernel_ticks++;
+  if (user)
+    t->usage.utime++;
+  else
+    t->usage.stime++;
+
+  /* Update -mlfqs statistics.  Only the running thread's
+     recent_cpu moves between the once-a-second decays, so it is
+     the only priority refreshed every fourth tick. */
+  if (thread_mlfqs)
+    {
+      if (t != idle_thread)
+        t->recent_cpu = fp_add_int (t->recent_cpu, 1);
+      if (timer_ticks () % TIMER_FREQ == 0)
+        mlfqs_update_second ();
+      else if (timer_ticks () % TIME_SLICE == 0 && t != idle_thread)
+        t->priority = mlfqs_priority (t);
+      thread_preempt ();
+    }
 
   /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  if (++thread_ticks >= time_slice[t->priority / PRI_BAND_SIZE])
     intr_yield_on_return ();
 }
 
+/* Sets the time slice of priority band BAND to TICKS timer
+   ticks. */
+void
+thread_set_time_slice (int band, unsigned ticks)
+{
+  ASSERT (band >= 0 && band < PRI_BAND_CNT);
+  ASSERT (ticks > 0);
+
+  time_slice[band] = ticks;
+}
+
+/* Adds the counts in B to A. */
+void
+rusage_add (struct rusage *a, const struct rusage *b)
+{
+  a->utime += b->utime;
+  a->stime += b->stime;
+  a->nvcsw += b->nvcsw;
+  a->nivcsw += b->nivcsw;
+}
+
+/* Credits TICKS timer ticks that passed while the idle thread
+   halted with the periodic timer interrupt switched off.  Called
+   by the timer code, with interrupts off. */
+void
+thread_tick_idle (int ticks)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (thread_current () == idle_thread);
+
+  idle_ticks += ticks;
+  idle_thread->usage.stime += ticks;
+}
+
+/* Returns T's priority under the -mlfqs scheduler. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+  int priority = PRI_MAX - fp_trunc (t->recent_cpu / 4) - t->nice * 2;
+
+  if (priority < PRI_MIN)
+    return PRI_MIN;
+  else if (priority > PRI_MAX)
+    return PRI_MAX;
+  else
+    return priority;
+}
+
+/* Recomputes load_avg, then decays every thread's recent_cpu and
+   refreshes its priority.  Runs once per second, in the timer
+   interrupt. */
+static void
+mlfqs_update_second (void)
+{
+  struct thread *cur = thread_current ();
+  int ready_threads = ready_cnt + (cur != idle_thread);
+  fixed_t decay;
+  struct list_elem *e;
+
+  load_avg = (59 * load_avg + fp_from_int (ready_threads)) / 60;
+  decay = fp_div (2 * load_avg, fp_add_int (2 * load_avg, 1));
+
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+
+      if (t == idle_thread)
+        continue;
+      t->recent_cpu = fp_add_int (fp_mul (decay, t->recent_cpu), t->nice);
+      thread_change_priority (t, mlfqs_priority (t));
+    }
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) 
 {
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread: %lld voluntary, %lld involuntary context switches\n",
+          vol_switches, invol_switches);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -168,9 +299,8 @@ thread_print_stats (void)
    scheduled.  Use a semaphore or some other form of
    synchronization if you need to ensure ordering.
 
-   The code provided sets the new thread's `priority' member to
-   PRIORITY, but no actual priority scheduling is implemented.
-   Priority scheduling is the goal of Problem 1-3. */
+   If the new thread has a higher priority than the running
+   thread, the running thread yields to it before returning. */
 tid_t
 thread_create (const char *name, int priority,
                thread_func *function, void *aux) 
@@ -184,18 +314,40 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = palloc_get_page (PAL_ZERO | PAL_TAG (MEM_THREAD));
   if (t == NULL)
     return TID_ERROR;
 
+#ifdef USERPROG
+  struct child_status* cs = malloc (sizeof *cs);
+  if (cs == NULL)
+  {
+    palloc_free_page (t);
+    return TID_ERROR;
+  }
+#endif
+
   /* Initialize thread. */
   init_thread (t, name, priority);
+  if (thread_mlfqs)
+    {
+      /* Inherit the creator's niceness and CPU history, and
+         ignore the requested priority (addition). */
+      t->nice = thread_current ()->nice;
+      t->recent_cpu = thread_current ()->recent_cpu;
+      t->priority = t->base_priority = mlfqs_priority (t);
+    }
   tid = t->tid = allocate_tid ();
 
   /* (addition) parent-child relation setting */
 #ifdef USERPROG
+  cs->tid = tid;
+  cs->exit_status = -1;
+  sema_init (&cs->wait_sema, 0);
+  cs->ref_cnt = 2;
+  t->child_status = cs;
   t->parent = thread_current ();
-  list_push_back (&t->parent->child_list, &t->childelem);
+  list_push_back (&t->parent->child_list, &cs->elem);
 #ifdef FILESYS
   t->cur_dir = thread_current ()->cur_dir;
 #endif
@@ -218,6 +370,7 @@ thread_create (const char *name, int priority,
 
   /* Add to run queue. */
   thread_unblock (t);
+  thread_preempt ();
 
   return tid;
 }
@@ -248,7 +401,8 @@ thread_sleep (void) //addition for alarm clock
   struct thread* cur = thread_current ();
   cur->status = THREAD_BLOCKED;
 
-  list_insert_ordered (&sleep_list, &cur->elem, thread_less_alarm_ticks, NULL);
+  cur->sleep_child = cur->sleep_sibling = NULL;
+  sleep_root = sleep_meld (sleep_root, cur);
 
   schedule ();
   intr_set_level (old_level);
@@ -271,7 +425,7 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_push_back (&ready_list, &t->elem);
+  ready_push (t);
   t->status = THREAD_READY;
   intr_set_level (old_level);
 }
@@ -281,19 +435,46 @@ thread_awake (void) //addition for alarm clock
 {
   enum intr_level old_level;
 
+  old_level = intr_disable ();
+
   ASSERT (!is_sleep_list_empty ());
-  struct thread* t = list_entry (list_pop_front (&sleep_list), struct thread, elem);
+  struct thread* t = sleep_root;
   ASSERT (is_thread (t));
+  sleep_root = sleep_merge_pairs (t->sleep_child);
 
-  old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
 
-  list_push_back (&ready_list, &t->elem);
+  ready_push (t);
 
   t->status = THREAD_READY;
   intr_set_level (old_level);
 }
 
+/* Yields the CPU if a ready thread has a higher priority than the
+   running thread.  In an interrupt handler, the yield happens on
+   return from the interrupt.  A caller that has turned interrupts
+   off is left alone, since yielding would break its critical
+   section; it gets preempted at the next timer tick instead. */
+void
+thread_preempt (void)
+{
+  enum intr_level old_level = intr_disable ();
+  struct thread *cur = running_thread ();
+  bool yield = false;
+
+  if (cur != idle_thread && ready_max_priority () > cur->priority)
+    {
+      if (intr_context ())
+        intr_yield_on_return ();
+      else
+        yield = old_level == INTR_ON;
+    }
+  intr_set_level (old_level);
+
+  if (yield)
+    thread_yield ();
+}
+
 /* Returns the name of the running thread. */
 const char *
 thread_name (void) 
@@ -337,10 +518,25 @@ thread_exit (void)
 #ifdef USERPROG
   process_exit ();
   printf ("%s: exit(%d)\n", thread_current ()->name, thread_current ()->exit_status);
-  while (!list_empty (&thread_current ()->child_list))
-    sema_up (&list_entry (list_pop_front (&thread_current ()->child_list), struct thread, childelem)->exit_sema);
-  sema_up (&thread_current ()->wait_sema);
-  sema_down (&thread_current ()->exit_sema);
+  console_flush ();
+
+  /* let go of the children, then hand the exit status to the
+     parent; nothing refers to this thread page afterward */
+  struct thread* cur = thread_current ();
+  while (!list_empty (&cur->child_list))
+    thread_release_child_status (list_entry (list_pop_front (&cur->child_list),
+                                             struct child_status, elem));
+  if (cur->child_status != NULL)
+  {
+    cur->child_status->exit_status = cur->exit_status;
+    enum intr_level old_level = intr_disable ();
+    cur->child_status->usage = cur->usage;
+    intr_set_level (old_level);
+    rusage_add (&cur->child_status->usage, &cur->child_usage);
+    sema_up (&cur->child_status->wait_sema);
+    thread_release_child_status (cur->child_status);
+    cur->child_status = NULL;
+  }
 #endif
 
   /* Remove thread from all threads list, set our status to dying,
@@ -365,7 +561,7 @@ thread_yield (void)
 
   old_level = intr_disable ();
   if (cur != idle_thread) 
-    list_push_back (&ready_list, &cur->elem);
+    ready_push (cur);
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -388,11 +584,97 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Sets the current thread's base priority to NEW_PRIORITY,
+   yielding if it no longer has the highest priority.  Priority
+   donated through held locks still applies on top of it. */
 void
 thread_set_priority (int new_priority) 
 {
-  thread_current ()->priority = new_priority;
+  enum intr_level old_level;
+
+  ASSERT (PRI_MIN <= new_priority && new_priority <= PRI_MAX);
+
+  /* The -mlfqs scheduler sets priorities itself. */
+  if (thread_mlfqs)
+    return;
+
+  old_level = intr_disable ();
+  thread_current ()->base_priority = new_priority;
+  thread_refresh_priority (thread_current ());
+  intr_set_level (old_level);
+
+  thread_preempt ();
+}
+
+/* Donates PRIORITY to T, which holds a lock the running thread
+   is about to wait for, and onward to whatever thread holds the
+   lock T is itself waiting for.  The chain is followed at most
+   DONATE_DEPTH_MAX links, which bounds the work done with
+   interrupts off and guards against a deadlock cycle.
+   Interrupts must be off. */
+#define DONATE_DEPTH_MAX 8
+void
+thread_donate_priority (struct thread *t, int priority)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; t != NULL && depth < DONATE_DEPTH_MAX; depth++)
+    {
+      if (t->priority >= priority)
+        break;
+      thread_change_priority (t, priority);
+      if (t->waiting_lock == NULL)
+        break;
+      t = t->waiting_lock->holder;
+    }
+}
+
+/* Recomputes T's priority as the higher of its base priority
+   and the priority of every thread waiting on a lock T holds.
+   Interrupts must be off. */
+void
+thread_refresh_priority (struct thread *t)
+{
+  int priority = t->base_priority;
+  struct list_elem *e, *w;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&t->held_locks); e != list_end (&t->held_locks);
+       e = list_next (e))
+    {
+      struct list *waiters = &list_entry (e, struct lock, elem)->semaphore.waiters;
+
+      for (w = list_begin (waiters); w != list_end (waiters); w = list_next (w))
+        {
+          struct thread *waiter = list_entry (w, struct thread, elem);
+          if (waiter->priority > priority)
+            priority = waiter->priority;
+        }
+    }
+  thread_change_priority (t, priority);
+}
+
+/* Sets T's effective priority, moving it to the matching run
+   queue if it is ready.  Interrupts must be off. */
+static void
+thread_change_priority (struct thread *t, int priority)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->priority == priority)
+    return;
+
+  if (t->status == THREAD_READY)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_push (t);
+    }
+  else
+    t->priority = priority;
 }
 
 /* Returns the current thread's priority. */
@@ -404,33 +686,49 @@ thread_get_priority (void)
 
 /* Sets the current thread's nice value to NICE. */
 void
-thread_set_nice (int nice UNUSED) 
+thread_set_nice (int nice) 
 {
-  /* Not yet implemented. */
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (NICE_MIN <= nice && nice <= NICE_MAX);
+
+  old_level = intr_disable ();
+  cur->nice = nice;
+  if (thread_mlfqs)
+    cur->priority = mlfqs_priority (cur);
+  intr_set_level (old_level);
+
+  thread_preempt ();
 }
 
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int load_avg_100 = fp_round (100 * load_avg);
+  intr_set_level (old_level);
+
+  return load_avg_100;
 }
 
 /* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int recent_cpu_100 = fp_round (100 * thread_current ()->recent_cpu);
+  intr_set_level (old_level);
+
+  return recent_cpu_100;
 }
 
 /* Idle thread.  Executes when no other thread is ready to run.
@@ -453,8 +751,12 @@ idle (void *idle_started_ UNUSED)
     {
       /* Let someone else run. */
       intr_disable ();
+      timer_idle_exit ();
       thread_block ();
 
+      /* Skip timer interrupts that nothing is waiting for. */
+      timer_idle_enter ();
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -528,19 +830,25 @@ init_thread (struct thread *t, const char *name, int priority)
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
   t->priority = priority;
+  t->base_priority = priority; //addition for priority donation
+  list_init (&t->held_locks); //addition for priority donation
+  t->waiting_lock = NULL; //addition for priority donation
+  t->nice = NICE_DEFAULT; //addition for mlfqs
+  t->recent_cpu = 0; //addition for mlfqs
   t->magic = THREAD_MAGIC;
 #ifdef USERPROG
   t->exit_status = -1; //addition
   t->exec_status = true; //addition
+  t->stdin_nonblock = false; //addition
   t->parent = NULL; //addition
   list_init (&t->child_list); //addition
+  t->child_status = NULL; //addition
   sema_init (&t->exec_sema, 0); //addition
-  sema_init (&t->wait_sema, 0); //addition
-  sema_init (&t->exit_sema, 0); //addition
   t->file_list = NULL; //addition
 #endif
 #ifdef VM
   t->map_list = NULL; //addition
+  t->heap_start = t->heap_brk = NULL; //addition
 #endif
 #ifdef FILESYS
   t->cur_dir = ROOT_DIR_SECTOR;
@@ -572,10 +880,72 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
+  int priority = ready_max_priority ();
+  struct thread *t;
+
+  if (priority < 0)
     return idle_thread;
+
+  t = list_entry (list_front (&ready_list[priority]), struct thread, elem);
+  ready_remove (t);
+  return t;
+}
+
+/* Returns true if thread A has a lower priority than thread B,
+   for use with list_max() on lists of threads linked by `elem'. */
+bool
+thread_less_priority (const struct list_elem *a_,
+                      const struct list_elem *b_, void *aux UNUSED)
+{
+  const struct thread *a = list_entry (a_, struct thread, elem);
+  const struct thread *b = list_entry (b_, struct thread, elem);
+
+  return a->priority < b->priority;
+}
+
+/* Adds T to the back of the run queue for its priority.
+   Interrupts must be off. */
+static void
+ready_push (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  list_push_back (&ready_list[t->priority], &t->elem);
+  ready_mask |= (uint64_t) 1 << t->priority;
+  ready_cnt++;
+}
+
+/* Removes ready thread T from its run queue.  Interrupts must be
+   off. */
+static void
+ready_remove (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  list_remove (&t->elem);
+  if (list_empty (&ready_list[t->priority]))
+    ready_mask &= ~((uint64_t) 1 << t->priority);
+  ready_cnt--;
+}
+
+/* Returns the highest priority of any ready thread, or -1 if no
+   thread is ready.  Interrupts must be off.  Works on 32-bit
+   halves so that the find-last-set compiles to a single bsr
+   without a libgcc helper. */
+static int
+ready_max_priority (void)
+{
+  uint32_t high = ready_mask >> 32;
+  uint32_t low = ready_mask;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (high != 0)
+    return 63 - __builtin_clz (high);
+  else if (low != 0)
+    return 31 - __builtin_clz (low);
   else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+    return -1;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -643,7 +1013,21 @@ schedule (void)
   ASSERT (is_thread (next));
 
   if (cur != next)
-    prev = switch_threads (cur, next);
+    {
+      /* A thread that is still ready was preempted; one that
+         blocked gave up the CPU itself. */
+      if (cur->status == THREAD_READY)
+        {
+          cur->usage.nivcsw++;
+          invol_switches++;
+        }
+      else if (cur->status == THREAD_BLOCKED)
+        {
+          cur->usage.nvcsw++;
+          vol_switches++;
+        }
+      prev = switch_threads (cur, next);
+    }
   thread_schedule_tail (prev);
 }
 
@@ -667,6 +1051,19 @@ uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
 #ifdef USERPROG
 
+/* (addition) drops one of the two references to CS, freeing it if
+   the other side has already let go */
+void
+thread_release_child_status (struct child_status* cs)
+{
+  enum intr_level old_level = intr_disable ();
+  bool last = --cs->ref_cnt == 0;
+  intr_set_level (old_level);
+
+  if (last)
+    free (cs);
+}
+
 /* (addition) push file to file_list */
 int
 thread_push_file (void* file)
@@ -675,7 +1072,7 @@ thread_push_file (void* file)
 
   if (thread_current ()->file_list == NULL)
   {
-    thread_current ()->file_list = palloc_get_page (PAL_ZERO);
+    thread_current ()->file_list = palloc_get_page (PAL_ZERO | PAL_TAG (MEM_PROCESS));
     thread_current ()->file_list[3] = file;
     return 3;
   }
@@ -737,7 +1134,7 @@ thread_push_map (struct map* map)
 {
   if (thread_current ()->map_list == NULL)
   {
-    thread_current ()->map_list = (struct map**) palloc_get_page (PAL_ZERO);
+    thread_current ()->map_list = (struct map**) palloc_get_page (PAL_ZERO | PAL_TAG (MEM_PROCESS));
     thread_current ()->map_list[0] = map;
     return 0;
   }
@@ -781,18 +1178,69 @@ thread_get_map (mapid_t id)
 
 #endif
 
-/* addition for alarm clock */
-static bool
-thread_less_alarm_ticks (const struct list_elem* a, const struct list_elem* b, void* aux UNUSED)
+/* Melds sleep heaps A and B, either of which may be empty, and
+   returns the new root.  Both roots must have no siblings.
+   (addition for alarm clock) */
+static struct thread*
+sleep_meld (struct thread* a, struct thread* b)
 {
-  return (list_entry (a, struct thread, elem)->alarm_ticks < list_entry (b, struct thread, elem)->alarm_ticks);
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if (b->alarm_ticks < a->alarm_ticks)
+    {
+      struct thread* tmp = a;
+      a = b;
+      b = tmp;
+    }
+  b->sleep_sibling = a->sleep_child;
+  a->sleep_child = b;
+  return a;
+}
+
+/* Melds the sibling list starting at FIRST into one heap and
+   returns its root, using the standard two passes: meld adjacent
+   pairs left to right, then meld the results right to left.
+   Iterative, so deep heaps cannot overflow the kernel stack.
+   (addition for alarm clock) */
+static struct thread*
+sleep_merge_pairs (struct thread* first)
+{
+  struct thread* pairs = NULL;
+  struct thread* root = NULL;
+
+  while (first != NULL)
+    {
+      struct thread* a = first;
+      struct thread* b = a->sleep_sibling;
+
+      first = b != NULL ? b->sleep_sibling : NULL;
+      a->sleep_sibling = NULL;
+      if (b != NULL)
+        {
+          b->sleep_sibling = NULL;
+          a = sleep_meld (a, b);
+        }
+      a->sleep_sibling = pairs;
+      pairs = a;
+    }
+
+  while (pairs != NULL)
+    {
+      struct thread* next = pairs->sleep_sibling;
+      pairs->sleep_sibling = NULL;
+      root = sleep_meld (root, pairs);
+      pairs = next;
+    }
+  return root;
 }
 
 /* addition for alarm clock */
 bool
 is_sleep_list_empty (void)
 {
-  return list_empty (&sleep_list);
+  return sleep_root == NULL;
 }
 
 /* addition for alarm clock */
@@ -801,7 +1249,7 @@ thread_slept_first (void)
 {
   ASSERT (!is_sleep_list_empty ());
 
-  return list_entry (list_front (&sleep_list), struct thread, elem);
+  return sleep_root;
 }
 
 /* addition for file and directory */
@@ -4,6 +4,8 @@
 #include <debug.h>
 #include <list.h>
 #include <stdint.h>
+#include <rusage.h>
+#include "threads/fixed-point.h" //addition
 #include "threads/synch.h" //addition
 
 /* States in a thread's life cycle. */
@@ -28,17 +30,44 @@ typedef int mapid_t;
 struct map
 {
   void* upage;
-  int fd;
+  size_t page_cnt;
+  struct file* file;	/* private file mapping: our own handle */
+  struct shm* shm;	/* shared mapping: the object mapped */
 };
 #endif
 
 #define TID_ERROR ((tid_t) -1)          /* Error value for tid_t. */
 
+/* (addition) what a parent needs to know about a child process.
+   Allocated apart from the child's struct thread and shared by
+   the two, so the child's thread page can be freed as soon as it
+   exits; whichever of the two lets go last frees it. */
+#ifdef USERPROG
+struct child_status
+{
+  tid_t tid;			/* child's thread identifier */
+  int exit_status;		/* valid once wait_sema is up */
+  struct rusage usage;		/* child's and its children's usage, valid with exit_status */
+  struct semaphore wait_sema;	/* upped by the child when it exits */
+  int ref_cnt;			/* 2 while both parent and child hold it */
+  struct list_elem elem;	/* list element for parent's child_list */
+};
+#endif
+
 /* Thread priorities. */
 #define PRI_MIN 0                       /* Lowest priority. */
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Priority bands, each with its own time slice (addition). */
+#define PRI_BAND_SIZE 16                /* Priorities per band. */
+#define PRI_BAND_CNT ((PRI_MAX + 1) / PRI_BAND_SIZE)
+
+/* Thread niceness, for the -mlfqs scheduler (addition). */
+#define NICE_MIN -20                    /* Nicest. */
+#define NICE_DEFAULT 0                  /* Default nice value. */
+#define NICE_MAX 20                     /* Least nice. */
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -102,8 +131,16 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Priority, including donations. */
+    int base_priority;			/* (addition) priority set by thread_set_priority */
+    struct list held_locks;		/* (addition) locks held, for donation */
+    struct lock *waiting_lock;		/* (addition) lock being waited for, if any */
+    int nice;				/* (addition) niceness, for -mlfqs */
+    fixed_t recent_cpu;			/* (addition) recent CPU use, for -mlfqs */
+    struct rusage usage;		/* (addition) CPU time and context switches */
     int64_t alarm_ticks;		/* (addition) when should I awake it? */
+    struct thread *sleep_child;		/* (addition) first child in sleep heap */
+    struct thread *sleep_sibling;	/* (addition) next sibling in sleep heap */
     struct list_elem allelem;           /* List element for all threads list. */
 
     /* Shared between thread.c and synch.c. */
@@ -112,20 +149,22 @@ struct thread
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     struct semaphore exec_sema;		/* (addition) semaphore for exec that parent holds */
-    struct semaphore wait_sema;		/* (addition) semaphore for wait that child holds */
-    struct semaphore exit_sema;		/* (addition) semaphore for exit that child holds */
-    struct list child_list;		/* (addition) child list */
-    struct list_elem childelem;		/* (addition) list element for child_list */
-    struct thread* parent;		/* (addition) parent thread */
+    struct list child_list;		/* (addition) children's child_status list */
+    struct child_status* child_status;	/* (addition) own record, shared with parent */
+    struct thread* parent;		/* (addition) parent thread, valid while it waits in exec */
     uint32_t *pagedir;			/* Page directory. */
     void** file_list;			/* (addition) file descriptor list */
     int exit_status;			/* (addition) exit status */
     bool exec_status;			/* (addition) whether exec(child) is successful */
+    bool stdin_nonblock;		/* (addition) whether reads on fd 0 never wait */
+    struct rusage child_usage;		/* (addition) usage of waited-for children */
 #endif
 
 #ifdef VM
     struct map** map_list;		/* (addition) memory mapped files list */
     void* saved_esp;			/* (addition) saved esp */
+    void* heap_start;			/* (addition) first heap byte, past the data segment */
+    void* heap_brk;			/* (addition) end of the heap, as set by sbrk */
 #endif
 
 #ifdef FILESYS
@@ -145,8 +184,11 @@ extern bool thread_mlfqs;
 void thread_init (void);
 void thread_start (void);
 
-void thread_tick (void);
+void thread_tick (bool user);
+void thread_tick_idle (int ticks);
 void thread_print_stats (void);
+void thread_set_time_slice (int band, unsigned ticks);
+void rusage_add (struct rusage *, const struct rusage *);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -162,6 +204,11 @@ const char *thread_name (void);
 
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
+void thread_preempt (void);
+void thread_donate_priority (struct thread *, int priority);
+void thread_refresh_priority (struct thread *);
+bool thread_less_priority (const struct list_elem *, const struct list_elem *,
+                           void *aux);
 
 /* Performs some operation on thread t, given auxiliary data AUX. */
 typedef void thread_action_func (struct thread *t, void *aux);
@@ -177,6 +224,7 @@ int thread_get_load_avg (void);
 
 /* addition (project 2) */
 #ifdef USERPROG
+void thread_release_child_status (struct child_status*);
 int thread_push_file (void*);
 void* thread_remove_file (int);
 void* thread_get_file (int);
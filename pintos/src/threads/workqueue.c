@@ -0,0 +1,242 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of worker threads. */
+#define WORKER_CNT 2
+
+/* Work items waiting for a worker, in queueing order. */
+static struct list pending_list = LIST_INITIALIZER (pending_list);
+
+/* Delayed work items, in order of increasing `when'. */
+static struct list delayed_list = LIST_INITIALIZER (delayed_list);
+
+/* Both lists are touched by the timer interrupt, so they are
+   protected by turning interrupts off, not by a lock.
+   PENDING_SEMA is upped once per item made pending; a worker
+   that finds the pending list empty because the item was
+   cancelled just waits again. */
+static struct semaphore pending_sema;
+
+/* The item each worker is running, or NULL.  Lets
+   work_cancel_sync() wait for a running function to return
+   without the worker touching the item afterward.  Workers
+   broadcast DONE_COND after every item. */
+static struct work *running[WORKER_CNT];
+static struct lock done_lock;
+static struct condition done_cond;
+
+static void worker (void *aux);
+static bool work_less_when (const struct list_elem *,
+                            const struct list_elem *, void *aux);
+static void make_pending (struct work *);
+
+/* Initializes the work queue and starts its workers.  Must be
+   called after thread_start(). */
+void
+workqueue_init (void) 
+{
+  int i;
+
+  sema_init (&pending_sema, 0);
+  lock_init (&done_lock);
+  cond_init (&done_cond);
+
+  for (i = 0; i < WORKER_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "worker%d", i);
+      thread_create (name, PRI_DEFAULT, worker, &running[i]);
+    }
+}
+
+/* Initializes W to call FUNC when it runs. */
+void
+work_init (struct work *w, work_func *func) 
+{
+  ASSERT (w != NULL);
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->when = 0;
+  w->state = WORK_IDLE;
+}
+
+/* Queues W to run as soon as a worker is free.  Returns true if
+   W was queued, false if it was already pending.  A delayed W is
+   moved up to run now.  May be called from an interrupt
+   handler. */
+bool
+work_queue (struct work *w) 
+{
+  enum intr_level old_level = intr_disable ();
+  bool queued = w->state != WORK_PENDING;
+
+  if (w->state == WORK_DELAYED)
+    list_remove (&w->elem);
+  if (queued)
+    make_pending (w);
+  intr_set_level (old_level);
+
+  return queued;
+}
+
+/* Queues W to run TICKS timer ticks from now.  Returns true if W
+   was queued, false if it was already pending or delayed, in
+   which case its schedule is left as it was.  May be called from
+   an interrupt handler. */
+bool
+work_queue_delayed (struct work *w, int64_t ticks) 
+{
+  enum intr_level old_level;
+  bool queued;
+
+  if (ticks <= 0)
+    return work_queue (w);
+
+  old_level = intr_disable ();
+  queued = w->state == WORK_IDLE;
+  if (queued)
+    {
+      w->when = timer_ticks () + ticks;
+      w->state = WORK_DELAYED;
+      list_insert_ordered (&delayed_list, &w->elem, work_less_when, NULL);
+    }
+  intr_set_level (old_level);
+
+  return queued;
+}
+
+/* Removes W from the queue if it is pending or delayed.  Returns
+   true if it was.  Does not wait for a run of W's function that
+   has already started; see work_cancel_sync() for that. */
+bool
+work_cancel (struct work *w) 
+{
+  enum intr_level old_level = intr_disable ();
+  bool cancelled = w->state != WORK_IDLE;
+
+  if (cancelled)
+    {
+      list_remove (&w->elem);
+      w->state = WORK_IDLE;
+    }
+  intr_set_level (old_level);
+
+  return cancelled;
+}
+
+/* Like work_cancel(), but also waits until no worker is running
+   W's function, so that the caller may free W afterward.  W's
+   function must not requeue W once this has been called.  Must
+   not be called from W's own function or from an interrupt
+   handler. */
+bool
+work_cancel_sync (struct work *w) 
+{
+  bool cancelled;
+  int i;
+
+  ASSERT (!intr_context ());
+
+  cancelled = work_cancel (w);
+  lock_acquire (&done_lock);
+  for (i = 0; i < WORKER_CNT; i++)
+    while (running[i] == w)
+      cond_wait (&done_cond, &done_lock);
+  lock_release (&done_lock);
+
+  return cancelled;
+}
+
+/* Moves delayed work that is due at tick NOW to the pending
+   list.  Called by the timer interrupt handler at each tick. */
+void
+workqueue_tick (int64_t now) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (!list_empty (&delayed_list))
+    {
+      struct work *w = list_entry (list_front (&delayed_list),
+                                   struct work, elem);
+      if (w->when > now)
+        break;
+      list_pop_front (&delayed_list);
+      make_pending (w);
+    }
+}
+
+/* Returns the tick at which the earliest delayed work item is
+   due, or INT64_MAX if there is none.  Interrupts must be off. */
+int64_t
+workqueue_next_tick (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (list_empty (&delayed_list))
+    return INT64_MAX;
+  return list_entry (list_front (&delayed_list), struct work, elem)->when;
+}
+
+/* Appends W to the pending list and wakes a worker.  Interrupts
+   must be off. */
+static void
+make_pending (struct work *w) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  w->state = WORK_PENDING;
+  list_push_back (&pending_list, &w->elem);
+  sema_up (&pending_sema);
+}
+
+/* Worker thread.  Runs pending work items forever, recording
+   the one it is running in *CURRENT_. */
+static void
+worker (void *current_) 
+{
+  struct work **current = current_;
+
+  for (;;) 
+    {
+      enum intr_level old_level;
+      struct work *w;
+
+      sema_down (&pending_sema);
+
+      old_level = intr_disable ();
+      if (list_empty (&pending_list))
+        {
+          /* Cancelled before we got to it. */
+          intr_set_level (old_level);
+          continue;
+        }
+      w = list_entry (list_pop_front (&pending_list), struct work, elem);
+      w->state = WORK_IDLE;
+      *current = w;
+      intr_set_level (old_level);
+
+      w->func (w);
+
+      lock_acquire (&done_lock);
+      *current = NULL;
+      cond_broadcast (&done_cond, &done_lock);
+      lock_release (&done_lock);
+    }
+}
+
+/* Orders work items by due tick. */
+static bool
+work_less_when (const struct list_elem *a_, const struct list_elem *b_,
+                void *aux UNUSED) 
+{
+  const struct work *a = list_entry (a_, struct work, elem);
+  const struct work *b = list_entry (b_, struct work, elem);
+
+  return a->when < b->when;
+}
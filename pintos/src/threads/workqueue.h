@@ -0,0 +1,54 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Deferred work.
+
+   A work item is a function to be called later by one of a small
+   pool of shared kernel worker threads, either as soon as a
+   worker is free or after a delay.  Subsystems embed a `struct
+   work' in their own data instead of each owning a thread that
+   mostly sleeps.
+
+   A work item is pending at most once: queueing it again before
+   it runs has no effect.  It may be queued again while (or from
+   within) its function is running, so a periodic job is simply
+   one that requeues itself with a delay.  Once a worker has
+   called a work item's function it does not touch the item
+   again, so the function may free it.  Work functions run in
+   thread context and may sleep, but a long-running one ties up a
+   worker. */
+
+struct work;
+typedef void work_func (struct work *);
+
+/* States of a work item. */
+enum work_state
+  {
+    WORK_IDLE,                  /* Not queued. */
+    WORK_DELAYED,               /* Waiting for its delay to expire. */
+    WORK_PENDING                /* Waiting for a worker. */
+  };
+
+struct work
+  {
+    struct list_elem elem;      /* Element in pending or delayed list. */
+    work_func *func;            /* Function to call. */
+    int64_t when;               /* Tick at which a delayed item is due. */
+    enum work_state state;      /* Queueing state. */
+  };
+
+void workqueue_init (void);
+void workqueue_tick (int64_t now);
+int64_t workqueue_next_tick (void);
+
+void work_init (struct work *, work_func *);
+bool work_queue (struct work *);
+bool work_queue_delayed (struct work *, int64_t ticks);
+bool work_cancel (struct work *);
+bool work_cancel_sync (struct work *);
+
+#endif /* threads/workqueue.h */
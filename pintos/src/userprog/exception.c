@@ -12,6 +12,7 @@
 #include "vm/page.h" //addition
 #include "vm/frame.h" //addition
 #include "vm/swap.h" //addition
+#include "vm/shm.h" //addition
 #include "filesys/file.h" //addition
 #endif
 
@@ -169,7 +170,21 @@ page_fault (struct intr_frame *f)
   sema_down (&pf_sema);
   void* fault_page = pg_round_down (fault_addr);
   enum spte_flag flag = spt_get_flag (fault_page);
-  if (not_present && flag != SPTE_INVALID)
+  if (not_present && flag == SPTE_SHM)
+  {
+    /* shared pages are already in a frame once any mapper touched
+       them; just point this page table at it */
+    uint32_t* pd = thread_current ()->pagedir;
+    void* kpage = shm_get_page (spt_get_ref (fault_page),
+                                spte_file_tell (fault_page) / PGSIZE);
+    if (kpage != NULL && pagedir_get_page (pd, fault_page) == NULL
+        && pagedir_set_page (pd, fault_page, kpage, spt_get_writable (fault_page)))
+    {
+      sema_up (&pf_sema);
+      return;
+    }
+  }
+  else if (not_present && flag != SPTE_INVALID)
   {
     uint32_t* pd = thread_current ()->pagedir;
     void* ref = spt_get_ref (fault_page);
@@ -203,6 +218,8 @@ page_fault (struct intr_frame *f)
           case SPTE_ZERO:
             memset (kpage, 0, PGSIZE);
             break;
+          case SPTE_SHM:
+            PANIC ("why SPTE_SHM here?");
           case SPTE_INVALID:
             PANIC ("why SPTE_INVALID again?");
         }
@@ -218,7 +235,7 @@ page_fault (struct intr_frame *f)
 
   void* esp = user ? f->esp : thread_current ()->saved_esp;
   if (not_present && fault_addr >= esp - 32
-		&& fault_page >= PHYS_BASE - (1 << 23)) //stack size limit 8MB
+		&& fault_page >= PHYS_BASE - STACK_LIMIT)
   {
     uint32_t* pd = thread_current ()->pagedir;
     void* kpage = falloc_get_frame (PAL_ZERO);
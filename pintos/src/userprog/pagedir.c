@@ -19,7 +19,7 @@ static void invalidate_pagedir (uint32_t *);
 uint32_t *
 pagedir_create (void) 
 {
-  uint32_t *pd = palloc_get_page (0);
+  uint32_t *pd = palloc_get_page (PAL_TAG (MEM_PAGEDIR));
   if (pd != NULL)
     memcpy (pd, init_page_dir, PGSIZE);
   return pd;
@@ -47,7 +47,6 @@ pagedir_destroy (uint32_t *pd)
           {
 #ifdef VM
             falloc_free_frame (pte_get_page (*pte));
-            ft_remove (pte_get_page (*pte));
 #else
             palloc_free_page (pte_get_page (*pte));
 #endif
@@ -80,7 +79,7 @@ lookup_page (uint32_t *pd, const void *vaddr, bool create)
     {
       if (create)
         {
-          pt = palloc_get_page (PAL_ZERO);
+          pt = palloc_get_page (PAL_ZERO | PAL_TAG (MEM_PAGEDIR));
           if (pt == NULL) 
             return NULL; 
       
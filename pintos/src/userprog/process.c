@@ -12,9 +12,11 @@
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h" //addition
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h" //addition
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
@@ -25,39 +27,121 @@
 #endif
 
 static thread_func start_process NO_RETURN;
+static tid_t execute (const char *cmd_line, bool async);
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
+static bool executable_ok (const char *file_name);
+static void elf_cache_init (void);
+
+/* Initializes the process module. */
+void
+process_init (void)
+{
+  elf_cache_init ();
+}
+
+/* A command line parsed into its arguments.
+   process_execute() builds it once, in a single page, and hands
+   it to the child, which copies STRINGS onto its user stack in
+   one piece.  STRINGS holds the ARGC arguments back to back, each
+   null-terminated, so the first one is the program name. */
+struct exec_args
+  {
+    bool async;                 /* Started by process_spawn()? */
+    int argc;                   /* Number of arguments. */
+    size_t size;                /* Bytes used in STRINGS. */
+    char strings[];             /* Argument strings. */
+  };
+
+/* Bytes of the initial user stack page used by ARGS: the strings,
+   word-alignment padding, argv[] with its null sentinel, argv,
+   argc and the fake return address. */
+static size_t
+exec_args_stack_size (const struct exec_args *args)
+{
+  return ROUND_UP (args->size, sizeof (char *))
+         + (args->argc + 1) * sizeof (char *)
+         + sizeof (char **) + sizeof (int) + sizeof (void *);
+}
 
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
-   thread id, or TID_ERROR if the thread cannot be created. */
+   thread id, or TID_ERROR if the thread cannot be created.
+   The new process reports whether it loaded by setting the
+   caller's exec_status and upping its exec_sema. */
 tid_t
 process_execute (const char *file_name) 
 {
-  char *fn_copy;
+  return execute (file_name, false);
+}
+
+/* Like process_execute(), but the new process does not report
+   back when it has loaded, so the caller need not wait for it.
+   The executable is only checked to exist and have valid
+   headers; if loading fails later anyway, the process exits with
+   status -1, which the caller sees through process_wait(). */
+tid_t
+process_spawn (const char *cmd_line) 
+{
+  return execute (cmd_line, true);
+}
+
+/* Does the work of process_execute() and, if ASYNC is true,
+   process_spawn(). */
+static tid_t
+execute (const char *file_name, bool async) 
+{
+  struct exec_args *args;
   tid_t tid;
 
-  /* Make a copy of FILE_NAME.
+  /* Parse FILE_NAME into its own page.
      Otherwise there's a race between the caller and load(). */
-  fn_copy = palloc_get_page (0);
-  if (fn_copy == NULL)
+  args = palloc_get_page (PAL_TAG (MEM_PROCESS));
+  if (args == NULL)
     return TID_ERROR;
 
-  strlcpy (fn_copy, file_name, PGSIZE);
+  const char dels[] = " ";
+  size_t room = PGSIZE - sizeof *args;
+  const char *p = file_name + strspn (file_name, dels);
+  args->async = async;
+  args->argc = 0;
+  args->size = 0;
+  while (*p != '\0')
+  {
+    size_t len = strcspn (p, dels);
+    if (args->size + len + 1 > room)
+    {
+      palloc_free_page (args);
+      return TID_ERROR;
+    }
+    memcpy (args->strings + args->size, p, len);
+    args->strings[args->size + len] = '\0';
+    args->size += len + 1;
+    args->argc++;
+    p += len;
+    p += strspn (p, dels);
+  }
 
-  char* fn_copy2 = palloc_get_page (0);
-  char dels[2] = {' ', '\0'};
-  size_t i = strspn (fn_copy, dels);
-  size_t j = strcspn (fn_copy + i, dels);
-  memcpy (fn_copy2, fn_copy + i, j);
-  fn_copy2[j] = '\0';
+  /* Everything must fit in the single initial stack page. */
+  if (args->argc == 0 || exec_args_stack_size (args) > PGSIZE)
+  {
+    palloc_free_page (args);
+    return TID_ERROR;
+  }
+
+  /* Nobody will wait for an asynchronous load, so catch missing
+     or malformed executables here. */
+  if (async && !executable_ok (args->strings))
+  {
+    palloc_free_page (args);
+    return TID_ERROR;
+  }
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (fn_copy2, PRI_DEFAULT, start_process, fn_copy);
-  palloc_free_page (fn_copy2);
+  tid = thread_create (args->strings, PRI_DEFAULT, start_process, args);
   if (tid == TID_ERROR)
   {
-    palloc_free_page (fn_copy);
+    palloc_free_page (args);
   }
   return tid;
 }
@@ -65,82 +149,58 @@ process_execute (const char *file_name)
 /* A thread function that loads a user process and starts it
    running. */
 static void
-start_process (void *file_name_)
+start_process (void *args_)
 {
-  char *file_name = palloc_get_page (0);
-  memcpy (file_name, file_name_, strlen (file_name_));
-  file_name[strlen (file_name_)] = '\0';
+  struct exec_args *args = args_;
   struct intr_frame if_;
   bool success;
 
-  /* calculate argc */
-  size_t argc = 0;
-  size_t size = strlen (file_name);
-  char dels[2] = {' ', '\0'};
-  for (size_t i = strspn (file_name, dels); i < size;)
-  {
-    argc++;
-    i += strcspn (file_name + i, dels);
-    i += strspn (file_name + i, dels);
-  }
-  ASSERT (argc != 0);
-
-  /* argument parsing */
-  char* argv[argc + 1];
-  char* p = file_name;
-  for (int i = 0; i < (int) argc; i++)
-    argv[i] = strtok_r (p, dels, &p);
-
   /* Initialize interrupt frame and load executable. */
   memset (&if_, 0, sizeof if_);
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
-  success = load (argv[0], &if_.eip, &if_.esp);
+  success = load (args->strings, &if_.eip, &if_.esp);
 
   /* pushing arguments */
   if (success)
   {
-    size_t total_size = 0;
-    for (int i = argc - 1; i >= 0; i--)
-    {
-      size_t size = strlen (argv[i]) + 1;
-      if_.esp -= size * sizeof (char);
-      memcpy (if_.esp, argv[i], size);
-      argv[i] = if_.esp;
-      total_size += size;
-    }
-    /* word-align */
-    int word_align = total_size % 4 == 0 ? 0 : 4 - total_size % 4;
-    if_.esp -= word_align;
+    /* all the strings in one piece, then word-align */
+    if_.esp -= args->size;
+    memcpy (if_.esp, args->strings, args->size);
+    char* strings = if_.esp;
+    if_.esp = (void*) ROUND_DOWN ((uintptr_t) if_.esp, sizeof (char*));
+
     /* pushing the addresses of each string + null pointer sentinel */
-    if_.esp -= 4;
-    *(char**)if_.esp = 0;
-    for (int i = argc - 1; i >= 0; i--)
+    char** argv = (char**) if_.esp - (args->argc + 1);
+    for (int i = 0; i < args->argc; i++)
     {
-      if_.esp -= 4;
-      *(char**)if_.esp = argv[i];
+      argv[i] = strings;
+      strings += strlen (strings) + 1;
     }
+    argv[args->argc] = 0;
+    if_.esp = argv;
+
     /* pushing argv and argc */
     if_.esp -= 4;
-    *(char***)if_.esp = if_.esp + 4;
+    *(char***)if_.esp = argv;
     if_.esp -= 4;
-    *(int*)if_.esp = argc;
+    *(int*)if_.esp = args->argc;
     /* pushing return address */
     if_.esp -= 4;
     *(void**)if_.esp = 0;
     //hex_dump ((uintptr_t) if_.esp, if_.esp, (size_t) (PHYS_BASE - if_.esp), true);
   }
 
-  /* set parent's exec_status */
-  if (thread_current ()->parent != NULL)
+  /* set parent's exec_status, unless it did not wait for us */
+  if (!args->async && thread_current ()->parent != NULL)
   {
     thread_current ()->parent->exec_status = success;
     sema_up (&thread_current ()->parent->exec_sema);
   }
 
   /* If load failed, quit. */
-  palloc_free_page (file_name);
+  palloc_free_page (args);
   if (!success) 
     thread_exit ();
 
@@ -167,23 +227,23 @@ int
 process_wait (tid_t child_tid) 
 {
   struct thread* cur = thread_current ();
-  struct thread* child = NULL;
+  struct child_status* child = NULL;
 
-  if (list_empty (&cur->child_list)) return -1;
-  for (struct list_elem* e = list_front (&cur->child_list); e != list_end (&cur->child_list); e = list_next (e))
+  for (struct list_elem* e = list_begin (&cur->child_list); e != list_end (&cur->child_list); e = list_next (e))
   {
-    if (child_tid == list_entry (e, struct thread, childelem)->tid)
+    if (child_tid == list_entry (e, struct child_status, elem)->tid)
     {
-      child = list_entry (e, struct thread, childelem);
+      child = list_entry (e, struct child_status, elem);
       break;
     }
   }
   if (child == NULL) return -1;
 
   sema_down (&child->wait_sema);
-  list_remove (&child->childelem);
+  list_remove (&child->elem);
   int status = child->exit_status;
-  sema_up (&child->exit_sema);
+  rusage_add (&cur->child_usage, &child->usage);
+  thread_release_child_status (child);
   return status;
 }
 
@@ -327,6 +387,41 @@ struct Elf32_Phdr
 #define PF_W 2          /* Writable. */
 #define PF_R 4          /* Readable. */
 
+/* A loadable segment, in the form load_segment() wants it. */
+struct elf_segment
+  {
+    uint32_t file_page;         /* Page-aligned offset in the file. */
+    uint32_t mem_page;          /* Page-aligned user virtual address. */
+    uint32_t read_bytes;        /* Bytes to read from the file. */
+    uint32_t zero_bytes;        /* Bytes to zero after those. */
+    bool writable;              /* Writable by the user process? */
+  };
+
+/* Parsed and validated layout of an executable.
+   Kept in elf_cache, keyed by inode, so that executing the same
+   program again skips reading and validating its headers. */
+struct elf_image
+  {
+    struct list_elem elem;      /* Element in elf_cache. */
+    struct inode *inode;        /* Executable's inode, kept open. */
+    unsigned write_gen;         /* inode_write_gen() when parsed. */
+    int ref_cnt;                /* elf_cache plus loads in progress. */
+    void (*entry) (void);       /* Entry point. */
+    int seg_cnt;                /* Number of loadable segments. */
+    struct elf_segment segs[];  /* Loadable segments. */
+  };
+
+/* Maximum number of executables in elf_cache. */
+#define ELF_CACHE_CNT 8
+
+/* Recently loaded executables, most recently used first. */
+static struct list elf_cache;
+static struct lock elf_cache_lock;
+
+static struct elf_image *elf_cache_get (struct file *, const char *file_name);
+static void elf_cache_forget (struct inode *);
+static void elf_image_release (struct elf_image *);
+static struct elf_image *elf_parse (struct file *, const char *file_name);
 static bool setup_stack (void **esp);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
@@ -341,9 +436,8 @@ bool
 load (const char* file_name, void (**eip) (void), void **esp)
 {
   struct thread *t = thread_current ();
-  struct Elf32_Ehdr ehdr;
+  struct elf_image *img = NULL;
   struct file *file = NULL;
-  off_t file_ofs;
   bool success = false;
   int i;
 
@@ -365,7 +459,195 @@ load (const char* file_name, void (**eip) (void), void **esp)
   thread_push_file (file);
 #endif
 
+  /* Get the executable's layout, reading and verifying its
+     headers only if it is not cached. */
+  img = elf_cache_get (file, file_name);
+  if (img == NULL)
+    goto done;
+
+  /* Set up the loadable segments. */
+  for (i = 0; i < img->seg_cnt; i++) 
+    {
+      const struct elf_segment *seg = &img->segs[i];
+      if (!load_segment (file, seg->file_page, (void *) seg->mem_page,
+                         seg->read_bytes, seg->zero_bytes, seg->writable))
+        goto done;
+#ifdef VM
+      /* The heap starts right after the highest segment. */
+      void *seg_end = (void *) (seg->mem_page + seg->read_bytes
+                                + seg->zero_bytes);
+      if (seg_end > t->heap_start)
+        t->heap_start = t->heap_brk = seg_end;
+#endif
+    }
+
+  /* Set up stack. */
+  if (!setup_stack (esp))
+    goto done;
+
+  /* Start address. */
+  *eip = img->entry;
+
+  success = true;
+
+ done:
+  /* We arrive here whether the load is successful or not. */
+  if (img != NULL) 
+    {
+      lock_acquire (&elf_cache_lock);
+      elf_image_release (img);
+      lock_release (&elf_cache_lock);
+    }
+#ifdef VM
+#else
+  file_close (file);
+#endif
+  return success;
+}
+
+/* Initializes the executable layout cache. */
+static void
+elf_cache_init (void) 
+{
+  list_init (&elf_cache);
+  lock_init (&elf_cache_lock);
+  inode_set_remove_hook (elf_cache_forget);
+}
+
+/* Drops the layout of INODE, which is being removed, from
+   elf_cache, so that the cache's reference does not keep the
+   deleted executable's sectors allocated. */
+static void
+elf_cache_forget (struct inode *inode) 
+{
+  struct list_elem *e;
+
+  lock_acquire (&elf_cache_lock);
+  for (e = list_begin (&elf_cache); e != list_end (&elf_cache);
+       e = list_next (e)) 
+    {
+      struct elf_image *img = list_entry (e, struct elf_image, elem);
+      if (img->inode == inode) 
+        {
+          list_remove (e);
+          elf_image_release (img);
+          break;
+        }
+    }
+  lock_release (&elf_cache_lock);
+}
+
+/* Returns the layout of executable FILE, named FILE_NAME, with a
+   reference held for the caller, or a null pointer if FILE is not
+   a valid executable.  The layout comes from elf_cache unless the
+   file was written since it was parsed. */
+static struct elf_image *
+elf_cache_get (struct file *file, const char *file_name) 
+{
+  struct inode *inode = file_get_inode (file);
+  struct elf_image *img;
+  struct list_elem *e;
+
+  lock_acquire (&elf_cache_lock);
+  for (e = list_begin (&elf_cache); e != list_end (&elf_cache);
+       e = list_next (e)) 
+    {
+      img = list_entry (e, struct elf_image, elem);
+      if (img->inode != inode)
+        continue;
+
+      list_remove (&img->elem);
+      if (img->write_gen == inode_write_gen (inode)
+          && !inode_is_removed (inode)) 
+        {
+          /* Hit: move to the front. */
+          list_push_front (&elf_cache, &img->elem);
+          img->ref_cnt++;
+          lock_release (&elf_cache_lock);
+          return img;
+        }
+
+      /* Stale. */
+      elf_image_release (img);
+      break;
+    }
+  lock_release (&elf_cache_lock);
+
+  img = elf_parse (file, file_name);
+  if (img == NULL)
+    return NULL;
+
+  lock_acquire (&elf_cache_lock);
+  /* Someone else may have parsed it meanwhile; keep only one. */
+  for (e = list_begin (&elf_cache); e != list_end (&elf_cache);
+       e = list_next (e)) 
+    if (list_entry (e, struct elf_image, elem)->inode == inode) 
+      {
+        list_remove (e);
+        elf_image_release (list_entry (e, struct elf_image, elem));
+        break;
+      }
+  if (list_size (&elf_cache) >= ELF_CACHE_CNT)
+    elf_image_release (list_entry (list_pop_back (&elf_cache),
+                                   struct elf_image, elem));
+  img->ref_cnt++;
+  list_push_front (&elf_cache, &img->elem);
+  lock_release (&elf_cache_lock);
+
+  return img;
+}
+
+/* Returns true if FILE_NAME names a valid executable.  As a side
+   effect, its layout is left in elf_cache for load(). */
+static bool
+executable_ok (const char *file_name) 
+{
+  struct file *file = filesys_open (file_name);
+  if (file == NULL) 
+    {
+      printf ("load: %s: open failed\n", file_name);
+      return false;
+    }
+
+  struct elf_image *img = elf_cache_get (file, file_name);
+  if (img != NULL) 
+    {
+      lock_acquire (&elf_cache_lock);
+      elf_image_release (img);
+      lock_release (&elf_cache_lock);
+    }
+  file_close (file);
+  return img != NULL;
+}
+
+/* Drops a reference to IMG, freeing it with the last one.
+   elf_cache_lock must be held. */
+static void
+elf_image_release (struct elf_image *img) 
+{
+  ASSERT (lock_held_by_current_thread (&elf_cache_lock));
+
+  if (--img->ref_cnt == 0) 
+    {
+      inode_close (img->inode);
+      free (img);
+    }
+}
+
+/* Reads and verifies the headers of executable FILE, named
+   FILE_NAME, and returns its layout with one reference held for
+   the caller, or a null pointer if FILE is not a valid
+   executable. */
+static struct elf_image *
+elf_parse (struct file *file, const char *file_name) 
+{
+  struct Elf32_Ehdr ehdr;
+  struct elf_image *img;
+  off_t file_ofs;
+  int i;
+
   /* Read and verify executable header. */
+  file_seek (file, 0);
   if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
       || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
       || ehdr.e_type != 2
@@ -375,9 +657,20 @@ load (const char* file_name, void (**eip) (void), void **esp)
       || ehdr.e_phnum > 1024) 
     {
       printf ("load: %s: error loading executable\n", file_name);
-      goto done; 
+      return NULL; 
     }
 
+  /* Room for every program header, though only PT_LOAD ones are
+     kept. */
+  img = malloc (sizeof *img + ehdr.e_phnum * sizeof img->segs[0]);
+  if (img == NULL)
+    return NULL;
+  img->inode = inode_reopen (file_get_inode (file));
+  img->write_gen = inode_write_gen (img->inode);
+  img->ref_cnt = 1;
+  img->entry = (void (*) (void)) ehdr.e_entry;
+  img->seg_cnt = 0;
+
   /* Read program headers. */
   file_ofs = ehdr.e_phoff;
   for (i = 0; i < ehdr.e_phnum; i++) 
@@ -385,11 +678,11 @@ load (const char* file_name, void (**eip) (void), void **esp)
       struct Elf32_Phdr phdr;
 
       if (file_ofs < 0 || file_ofs > file_length (file))
-        goto done;
+        goto fail;
       file_seek (file, file_ofs);
 
       if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
-        goto done;
+        goto fail;
       file_ofs += sizeof phdr;
       switch (phdr.p_type) 
         {
@@ -403,58 +696,45 @@ load (const char* file_name, void (**eip) (void), void **esp)
         case PT_DYNAMIC:
         case PT_INTERP:
         case PT_SHLIB:
-          goto done;
+          goto fail;
         case PT_LOAD:
           if (validate_segment (&phdr, file)) 
             {
-              bool writable = (phdr.p_flags & PF_W) != 0;
-              uint32_t file_page = phdr.p_offset & ~PGMASK;
-              uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
+              struct elf_segment *seg = &img->segs[img->seg_cnt++];
               uint32_t page_offset = phdr.p_vaddr & PGMASK;
-              uint32_t read_bytes, zero_bytes;
+              seg->writable = (phdr.p_flags & PF_W) != 0;
+              seg->file_page = phdr.p_offset & ~PGMASK;
+              seg->mem_page = phdr.p_vaddr & ~PGMASK;
               if (phdr.p_filesz > 0)
                 {
                   /* Normal segment.
                      Read initial part from disk and zero the rest. */
-                  read_bytes = page_offset + phdr.p_filesz;
-                  zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-                                - read_bytes);
+                  seg->read_bytes = page_offset + phdr.p_filesz;
+                  seg->zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
+                                     - seg->read_bytes);
                 }
               else 
                 {
                   /* Entirely zero.
                      Don't read anything from disk. */
-                  read_bytes = 0;
-                  zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
+                  seg->read_bytes = 0;
+                  seg->zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
                 }
-              if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
-                goto done;
             }
           else
-            goto done;
+            goto fail;
           break;
         }
     }
+  return img;
 
-  /* Set up stack. */
-  if (!setup_stack (esp))
-    goto done;
-
-  /* Start address. */
-  *eip = (void (*) (void)) ehdr.e_entry;
-
-  success = true;
-
- done:
-  /* We arrive here whether the load is successful or not. */
-#ifdef VM
-#else
-  file_close (file);
-#endif
-  return success;
+ fail:
+  lock_acquire (&elf_cache_lock);
+  elf_image_release (img);
+  lock_release (&elf_cache_lock);
+  return NULL;
 }
-
+
 /* load() helpers. */
 
 static bool install_page (void *upage, void *kpage, bool writable);
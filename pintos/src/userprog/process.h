@@ -7,7 +7,9 @@
 #include "threads/synch.h" //addition
 #endif
 
+void process_init (void);
 tid_t process_execute (const char *file_name);
+tid_t process_spawn (const char *cmd_line);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
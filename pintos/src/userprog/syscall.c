@@ -12,12 +12,17 @@
 #include "threads/vaddr.h" //addition
 #include "userprog/pagedir.h" //addition
 #include <string.h> //addition
+#include <limits.h> //addition
 #include "lib/string.h" //addition
+#include <mman.h> //addition
+#include <round.h> //addition
 #ifdef VM
 #include "vm/page.h" //addition
 #include "vm/frame.h" //addition
 #include "vm/swap.h" //addition
+#include "vm/shm.h" //addition
 #include "threads/malloc.h" //addition
+#include "threads/slab.h" //addition
 #endif
 #ifdef FILESYS
 #include "filesys/free-map.h" //addition
@@ -28,6 +33,7 @@ static void syscall_handler (struct intr_frame *);
 
 static void exit (int);
 static tid_t exec (const char*);
+static tid_t spawn (const char*);
 static int wait (tid_t);
 static bool create (const char*, unsigned);
 static bool remove (const char*);
@@ -38,8 +44,15 @@ static int write (int, const void*, unsigned);
 static void seek (int, unsigned);
 static unsigned tell (int);
 static void close (int);
+static int copy_file_range (int, int, unsigned);
+static bool setnonblock (int, bool);
+static int poll (int);
+static int getrusage (int, struct rusage*);
 #ifdef VM
 static mapid_t mmap (int, void*);
+static mapid_t mmap_ex (int, void*, size_t, int);
+static void* sbrk (intptr_t);
+static void heap_drop (void*);
 //static void munmap (mapid_t); //declared in the header already
 #endif
 #ifdef FILESYS
@@ -59,6 +72,7 @@ static void unpin (void*);
 static void unpin_buf (void*, unsigned);
 static void unpin_str (char*);
 static void* esp;
+static struct kmem_cache* map_cache;	/* mmap records */
 #endif
 
 void
@@ -66,6 +80,9 @@ syscall_init (void)
 {
   //sema_init (&filesynch, 1);
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+#ifdef VM
+  map_cache = kmem_cache_create ("map", sizeof (struct map), NULL);
+#endif
 }
 
 static void
@@ -75,6 +92,7 @@ syscall_handler (struct intr_frame *f)
   //thread_exit ();
 
   int int_;
+  int int2_;
   char* str_;
   tid_t pid_;
   unsigned unsigned_ = 0;
@@ -146,6 +164,30 @@ syscall_handler (struct intr_frame *f)
       int_ = *(int*) valid (f->esp + 4);
       close (int_);
       break;
+    case SYS_COPY_FILE_RANGE:
+      unsigned_ = *(unsigned*) valid (f->esp + 12);
+      int2_ = *(int*) valid (f->esp + 8);
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = (uint32_t) copy_file_range (int_, int2_, unsigned_);
+      break;
+    case SYS_SETNONBLOCK:
+      unsigned_ = *(unsigned*) valid (f->esp + 8);
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = (uint32_t) setnonblock (int_, unsigned_ != 0);
+      break;
+    case SYS_POLL:
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = (uint32_t) poll (int_);
+      break;
+    case SYS_SPAWN:
+      str_ = valid_str (*(char**) valid (f->esp + 4));
+      f->eax = (uint32_t) spawn (str_);
+      break;
+    case SYS_GETRUSAGE:
+      buf_ = valid_buf (*(void**) valid (f->esp + 8), sizeof (struct rusage));
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = (uint32_t) getrusage (int_, buf_);
+      break;
 #ifdef VM
     case SYS_MMAP:
       buf_ = *(void**) valid (f->esp + 8);
@@ -156,6 +198,17 @@ syscall_handler (struct intr_frame *f)
       int_ = *(int*) valid (f->esp + 4);
       munmap (int_);
       break;
+    case SYS_MMAP_EX:
+      int2_ = *(int*) valid (f->esp + 16);
+      unsigned_ = *(unsigned*) valid (f->esp + 12);
+      buf_ = *(void**) valid (f->esp + 8);
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = mmap_ex (int_, buf_, unsigned_, int2_);
+      break;
+    case SYS_SBRK:
+      int_ = *(int*) valid (f->esp + 4);
+      f->eax = (uint32_t) sbrk (int_);
+      break;
 #endif
 #ifdef FILESYS
     case SYS_CHDIR:
@@ -235,6 +288,27 @@ syscall_handler (struct intr_frame *f)
     case SYS_CLOSE:
       unpin (f->esp + 4);
       break;
+    case SYS_COPY_FILE_RANGE:
+      unpin (f->esp + 12);
+      unpin (f->esp + 8);
+      unpin (f->esp + 4);
+      break;
+    case SYS_SETNONBLOCK:
+      unpin (f->esp + 8);
+      unpin (f->esp + 4);
+      break;
+    case SYS_POLL:
+      unpin (f->esp + 4);
+      break;
+    case SYS_SPAWN:
+      unpin_str (*(char**)(f->esp + 4));
+      unpin (f->esp + 4);
+      break;
+    case SYS_GETRUSAGE:
+      unpin_buf (*(void**)(f->esp + 8), sizeof (struct rusage));
+      unpin (f->esp + 8);
+      unpin (f->esp + 4);
+      break;
     case SYS_MMAP:
       //unpin (*(void**)(f->esp + 8)); //not needed
       unpin (f->esp + 8);
@@ -243,6 +317,15 @@ syscall_handler (struct intr_frame *f)
     case SYS_MUNMAP:
       unpin (f->esp + 4);
       break;
+    case SYS_MMAP_EX:
+      unpin (f->esp + 16);
+      unpin (f->esp + 12);
+      unpin (f->esp + 8);
+      unpin (f->esp + 4);
+      break;
+    case SYS_SBRK:
+      unpin (f->esp + 4);
+      break;
 #ifdef FILESYS
     case SYS_CHDIR:
       unpin_str (*(char**)(f->esp + 4));
@@ -281,10 +364,20 @@ static tid_t
 exec (const char* cmd_line)
 {
   tid_t pid = process_execute (cmd_line);
+  if (pid == TID_ERROR)
+    return -1;
   sema_down (&thread_current ()->exec_sema);
   return thread_current ()->exec_status ? pid : (tid_t) -1;
 }
 
+/* (addition) like exec, but returns as soon as the child exists;
+   a child that then fails to load exits with -1 for wait */
+static tid_t
+spawn (const char* cmd_line)
+{
+  return process_spawn (cmd_line);
+}
+
 static int
 wait (tid_t pid)
 {
@@ -359,9 +452,22 @@ read (int fd, void* buffer, unsigned size)
 {
   if (fd == 0)
   {
-    for (unsigned i = 0; i < size; i++)
-      input_getc();
-    return size;
+    /* waits only for the first key (never in non-blocking mode), then
+       takes whatever else is already buffered; keys are staged in a
+       kernel buffer so the user buffer is never touched with
+       interrupts off */
+    bool block = !thread_current ()->stdin_nonblock;
+    uint8_t keys[64];
+    unsigned result = 0;
+    while (result < size)
+    {
+      unsigned chunk = size - result < sizeof keys ? size - result : sizeof keys;
+      size_t cnt = input_getbuf (keys, chunk, block && result == 0);
+      if (cnt == 0) break;
+      memcpy ((uint8_t*) buffer + result, keys, cnt);
+      result += cnt;
+    }
+    return result;
   }
   else if (fd < 0 || fd == 1 || fd == 2 || fd >= MAX_FILE_CNT)
     thread_exit ();
@@ -445,49 +551,168 @@ close (int fd)
   //sema_up (&filesynch);
 }
 
+/* (addition) copies up to LENGTH bytes from FD_IN to FD_OUT inside
+   the kernel, starting at each file's position, so the data never
+   bounces through a user buffer.  overlapping ranges of one file
+   are refused with -1 */
+static int
+copy_file_range (int fd_in, int fd_out, unsigned length)
+{
+  if (fd_in < 3 || fd_in >= MAX_FILE_CNT || fd_out < 3 || fd_out >= MAX_FILE_CNT)
+    thread_exit ();
+#ifdef FILESYS
+  if (thread_fd_is_dir (fd_in) || thread_fd_is_dir (fd_out)) thread_exit ();
+#endif
+  struct file* file_in = thread_get_file (fd_in);
+  struct file* file_out = thread_get_file (fd_out);
+  if (file_in == NULL || file_out == NULL)
+    return -1;
+  return file_copy (file_out, file_in, length > INT_MAX ? INT_MAX : (off_t) length);
+}
+
+/* (addition) makes reads on fd 0 return only buffered keys (possibly
+   none) instead of waiting; other fds never wait anyway */
+static bool
+setnonblock (int fd, bool nonblock)
+{
+  if (fd != 0) return false;
+  thread_current ()->stdin_nonblock = nonblock;
+  return true;
+}
+
+/* (addition) returns how many bytes a read on FD would return
+   without waiting, or -1 if FD is not readable */
+static int
+poll (int fd)
+{
+  if (fd == 0)
+    return input_ready ();
+  if (fd < 3 || fd >= MAX_FILE_CNT)
+    return -1;
+#ifdef FILESYS
+  if (thread_fd_is_dir (fd)) return -1;
+#endif
+  struct file* file = thread_get_file (fd);
+  if (file == NULL)
+    return -1;
+  off_t left = file_length (file) - file_tell (file);
+  return left > 0 ? left : 0;
+}
+
+/* (addition) fills USAGE with the CPU usage of this process or of
+   its waited-for children, or returns -1 for any other WHO */
+static int
+getrusage (int who, struct rusage* usage)
+{
+  struct thread* cur = thread_current ();
+
+  if (who == RUSAGE_SELF)
+  {
+    enum intr_level old_level = intr_disable ();
+    *usage = cur->usage;
+    intr_set_level (old_level);
+  }
+  else if (who == RUSAGE_CHILDREN)
+    *usage = cur->child_usage;
+  else
+    return -1;
+  return 0;
+}
+
 #ifdef VM
 static mapid_t
 mmap (int fd, void* addr)
 {
-#ifdef FILESYS
-  ASSERT (!thread_fd_is_dir (fd));
-#endif
+  return mmap_ex (fd, addr, 0, MAP_PRIVATE);
+}
+
+/* maps LENGTH bytes at ADDR, or the whole file if LENGTH is 0.
+   with MAP_ANONYMOUS the pages start zeroed and FD is ignored,
+   unless MAP_SHARED is also given: then FD is a key, and every
+   process mapping the same key sees the same memory.  a shared
+   file mapping shares the frames with the other shared mappings of
+   that file, and is written back when the last one goes away */
+static mapid_t
+mmap_ex (int fd, void* addr, size_t length, int flags)
+{
+  bool anon = (flags & MAP_ANONYMOUS) != 0;
+  bool shared = (flags & MAP_SHARED) != 0;
+  struct file* file = NULL;
+  struct shm* shm = NULL;
+  off_t file_len = 0;
+
+  if (pg_ofs (addr) != 0 || addr == 0 || is_kernel_vaddr (addr))
+    return -1;
 
   sema_down (&pf_sema);
 
-  struct file* file = (fd <= 2 || fd >= MAX_FILE_CNT) ? NULL : thread_get_file (fd);
-  off_t size = (file == NULL) ? 0 : file_length (file);
-  if (size == 0 || pg_ofs (addr) != 0 || addr == 0 || is_kernel_vaddr (addr))
+  if (!anon)
   {
-    sema_up (&pf_sema);
-    return -1;
+    file = (fd <= 2 || fd >= MAX_FILE_CNT) ? NULL : thread_get_file (fd);
+    if (file == NULL)
+      goto fail;
+#ifdef FILESYS
+    ASSERT (!thread_fd_is_dir (fd));
+#endif
+    file_len = file_length (file);
+    if (length == 0)
+      length = file_len;
   }
+  size_t page_cnt = DIV_ROUND_UP (length, PGSIZE);
+  if (page_cnt == 0 || page_cnt > (size_t) (PHYS_BASE - addr) / PGSIZE)
+    goto fail;
 
-  bool success = true;
-  for (int i = 0; i < size; i = i + PGSIZE)
+  for (size_t i = 0; i < page_cnt; i++)
+    if (spt_get_flag (addr + i * PGSIZE) != SPTE_INVALID)
+      goto fail;
+
+  struct map* map = kmem_cache_alloc (map_cache);
+  if (map == NULL)
+    goto fail;
+  if (shared)
+    shm = shm_open (anon ? fd : 0, file, page_cnt);
+  else if (!anon)
+    file = file_reopen (file);
+  if (shared ? shm == NULL : !anon && file == NULL)
   {
-    if (spt_get_flag (addr + i) != SPTE_INVALID)
-      success = false;
+    kmem_cache_free (map_cache, map);
+    goto fail;
   }
-  if (!success)
+  map->upage = addr;
+  map->page_cnt = page_cnt;
+  map->file = shared ? NULL : file;
+  map->shm = shm;
+  mapid_t result = thread_push_map (map);
+  if (result == -1)
   {
-    sema_up (&pf_sema);
-    return -1;
+    if (shm != NULL)
+      shm_close (shm);
+    else
+      file_close (map->file);
+    kmem_cache_free (map_cache, map);
+    goto fail;
   }
 
-  file = file_reopen (file);
-  for (int i = 0; i < size; i = i + PGSIZE)
+  for (size_t i = 0; i < page_cnt; i++)
   {
-    spt_set (addr + i, file, SPTE_FILE, true);
-    spte_file_seek (addr + i, i);
+    void* upage = addr + i * PGSIZE;
+    /* pages wholly past the end of the file have nothing to read */
+    if (shm != NULL)
+      spt_set (upage, shm, SPTE_SHM, true);
+    else if (map->file != NULL && (off_t) (i * PGSIZE) < file_len)
+      spt_set (upage, map->file, SPTE_FILE, true);
+    else
+      spt_set (upage, NULL, SPTE_ZERO, true);
+    if (shm != NULL || map->file != NULL)
+      spte_file_seek (upage, i * PGSIZE);
   }
-  struct map* map = malloc (sizeof *map);
-  map->upage = addr;
-  map->fd = fd;
-  mapid_t result = thread_push_map (map);
 
   sema_up (&pf_sema);
   return result;
+
+ fail:
+  sema_up (&pf_sema);
+  return -1;
 }
 
 void
@@ -503,47 +728,129 @@ munmap (mapid_t mapping)
   }
 
   void* addr = map->upage;
-  struct file* file = thread_get_file (map->fd);
-  off_t size = (file == NULL) ? 0 : file_length (file);
-  free (map);
-  if (size == 0)
-  {
-    sema_up (&pf_sema);
-    return;
-  }
-
+  struct file* file = map->file;
+  off_t file_len = file != NULL ? file_length (file) : 0;
   uint32_t* pd = thread_current ()->pagedir;
-  for (int i = 0; i < size; i = i + PGSIZE)
+  for (size_t i = 0; i < map->page_cnt; i++)
   {
-    void* kpage = pagedir_get_page (pd, addr + i);
-    if (kpage != NULL)
+    void* upage = addr + i * PGSIZE;
+    void* kpage = pagedir_get_page (pd, upage);
+    if (map->shm != NULL)
     {
-      if (pagedir_is_dirty (pd, addr + i))
+      /* the frame belongs to the object, not to us */
+      if (kpage != NULL)
       {
-        //sema_down (&filesynch);
-        size_t write_bytes = file_write_at (file, kpage, PGSIZE, spte_file_tell (addr + i));
-        if (write_bytes == 0) PANIC ("why writing back nothing????");
-        //sema_up (&filesynch);
+        if (pagedir_is_dirty (pd, upage))
+          shm_set_dirty (map->shm, i);
+        pagedir_clear_page (pd, upage);
       }
-      pagedir_clear_page (pd, addr + i);
-      falloc_free_frame (kpage);
-      ft_remove (kpage);
+      spt_remove (upage);
     }
-    else if (spt_get_flag (addr + i) == SPTE_SWAP)
+    else if (file == NULL)
+      heap_drop (upage);
+    else
     {
-      void* temp = malloc (PGSIZE);
-      swap_in (spt_get_ref (addr + i), temp);
+      /* write back only what lies inside the file; the mapping
+         never makes it grow */
+      off_t ofs = i * PGSIZE;
+      off_t write_bytes = file_len - ofs < PGSIZE ? file_len - ofs : PGSIZE;
+      if (kpage != NULL)
+      {
+        if (write_bytes > 0 && pagedir_is_dirty (pd, upage))
+        {
+          //sema_down (&filesynch);
+          file_write_at (file, kpage, write_bytes, ofs);
+          //sema_up (&filesynch);
+        }
+        pagedir_clear_page (pd, upage);
+        falloc_free_frame (kpage);
+      }
+      else if (spt_get_flag (upage) == SPTE_SWAP)
+      {
+        void* temp = malloc (PGSIZE);
+        if (temp == NULL)
+          swap_free (spt_get_ref (upage));
+        else if (swap_in (spt_get_ref (upage), temp) && write_bytes > 0)
+        {
+          //sema_down (&filesynch);
+          file_write_at (file, temp, write_bytes, ofs);
+          //sema_up (&filesynch);
+        }
+        free (temp);
+      }
+      spt_remove (upage);
+    }
+  }
 
-      //sema_down (&filesynch);
-      file_write_at (file, temp, PGSIZE, spte_file_tell (addr + i));
-      //sema_up (&filesynch);
+  if (map->shm != NULL)
+    shm_close (map->shm);
+  file_close (file);
+  kmem_cache_free (map_cache, map);
 
-      free (temp);
-    }
-    spt_remove (addr + i);
+  sema_up (&pf_sema);
+}
+#endif
+
+#ifdef VM
+/* drops the anonymous page UPAGE, from the heap or a private
+   MAP_ANONYMOUS mapping: its frame or swap slot and its spte */
+static void
+heap_drop (void* upage)
+{
+  uint32_t* pd = thread_current ()->pagedir;
+  void* kpage = pagedir_get_page (pd, upage);
+
+  if (kpage != NULL)
+  {
+    pagedir_clear_page (pd, upage);
+    falloc_free_frame (kpage);
   }
+  else if (spt_get_flag (upage) == SPTE_SWAP)
+    swap_free (spt_get_ref (upage));
+  spt_remove (upage);
+}
 
+/* moves the end of the heap by INCREMENT bytes and returns the old
+   end, or (void*) -1 if the heap would shrink below its start, run
+   into the stack area or overlap a mapping.  new heap pages are
+   zero pages, faulted in on first touch */
+static void*
+sbrk (intptr_t increment)
+{
+  struct thread* t = thread_current ();
+  uint8_t* old_brk = t->heap_brk;
+  uint8_t* new_brk = old_brk + increment;
+
+  if (old_brk == NULL)
+    return (void*) -1;
+  if (increment < 0 ? new_brk < (uint8_t*) t->heap_start || new_brk > old_brk
+                    : new_brk < old_brk || new_brk > (uint8_t*) PHYS_BASE - STACK_LIMIT)
+    return (void*) -1;
+
+  sema_down (&pf_sema);
+  uint8_t* old_top = pg_round_up (old_brk);
+  uint8_t* new_top = pg_round_up (new_brk);
+  uint8_t* upage;
+  for (upage = old_top; upage < new_top; upage += PGSIZE)
+    if (spt_get_flag (upage) != SPTE_INVALID)
+    {
+      /* something is mapped there already; undo */
+      while (upage > old_top)
+      {
+        upage -= PGSIZE;
+        spt_remove (upage);
+      }
+      sema_up (&pf_sema);
+      return (void*) -1;
+    }
+    else
+      spt_set (upage, NULL, SPTE_ZERO, true);
+  for (upage = new_top; upage < old_top; upage += PGSIZE)
+    heap_drop (upage);
+  t->heap_brk = new_brk;
   sema_up (&pf_sema);
+
+  return old_brk;
 }
 #endif
 
@@ -559,8 +866,8 @@ chdir (const char* name)
 
   bool success = (filesys_parse (name, &dir, parsed_name, &dummy) && dir != NULL);
 
-  struct lock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
-  if (lock != NULL) lock_acquire (lock);
+  struct rwlock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
+  if (lock != NULL) rwlock_acquire_read (lock);
 
   if (success)
   {
@@ -576,9 +883,10 @@ chdir (const char* name)
   }
 
   inode_close (inode);
-  dir_close (dir);
 
-  if (lock != NULL) lock_release (lock);
+  /* the lock goes away with the directory's last close */
+  if (lock != NULL) rwlock_release_read (lock);
+  dir_close (dir);
   return success;
 }
 
@@ -597,8 +905,8 @@ mkdir (const char* name)
 			free_map_allocate (1, &inode_sector) &&
 			inode_create (inode_sector, 0));
 
-  struct lock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
-  if (lock != NULL) lock_acquire (lock);
+  struct rwlock* lock = (dir == NULL) ? NULL : inode_dir_lock (dir_get_inode (dir));
+  if (lock != NULL) rwlock_acquire_write (lock);
 
   success = success && dir_add (dir, parsed_name, inode_sector);
 
@@ -606,9 +914,10 @@ mkdir (const char* name)
 
   if (!success && inode_sector != 0)
     free_map_release (inode_sector, 1);
-  dir_close (dir);
 
-  if (lock != NULL) lock_release (lock);
+  /* the lock goes away with the directory's last close */
+  if (lock != NULL) rwlock_release_write (lock);
+  dir_close (dir);
   return success;
 }
 
@@ -19,15 +19,24 @@ struct fte
   bool pinned;
 };
 
+/* indexed by palloc arena page index.  user frames can come from
+   anywhere in the arena as the user pool grows, so the table grows
+   on demand to cover the highest frame seen */
 static struct fte* ft;
+static size_t ft_cnt;
 static struct lock ft_lock;
 static size_t victim_idx;
 
+static struct fte* ft_entry (void*, bool);
+
 void
 ft_init (void)
 {
-  ft = malloc (bitmap_size (get_user_pool_bitmap ()) * sizeof (struct fte));
-  for (size_t i = 0; i < bitmap_size (get_user_pool_bitmap ()); i++)
+  ft_cnt = palloc_user_limit ();
+  ft = malloc (ft_cnt * sizeof (struct fte));
+  if (ft == NULL)
+    PANIC ("no memory for the frame table");
+  for (size_t i = 0; i < ft_cnt; i++)
   {
     ft[i].present = false;
     ft[i].pinned = false;
@@ -36,6 +45,39 @@ ft_init (void)
   lock_init (&ft_lock);
 }
 
+/* returns the entry for KPAGE, or NULL if it lies past the end of
+   the table.  with GROW, the table is first grown to cover it.
+   ft_lock must be held */
+static struct fte*
+ft_entry (void* kpage, bool grow)
+{
+  size_t idx = palloc_page_idx (kpage);
+
+  ASSERT (lock_held_by_current_thread (&ft_lock));
+  if (idx >= ft_cnt)
+  {
+    if (!grow)
+      return NULL;
+
+    size_t new_cnt = ft_cnt > 0 ? ft_cnt : 1;
+    while (new_cnt <= idx)
+      new_cnt *= 2;
+    if (new_cnt > palloc_page_cnt ())
+      new_cnt = palloc_page_cnt ();
+    struct fte* new_ft = realloc (ft, new_cnt * sizeof (struct fte));
+    if (new_ft == NULL)
+      PANIC ("no memory to grow the frame table");
+    for (size_t i = ft_cnt; i < new_cnt; i++)
+    {
+      new_ft[i].present = false;
+      new_ft[i].pinned = false;
+    }
+    ft = new_ft;
+    ft_cnt = new_cnt;
+  }
+  return &ft[idx];
+}
+
 void
 ft_set (void* kpage, void* upage)
 {
@@ -43,7 +85,7 @@ ft_set (void* kpage, void* upage)
   ASSERT (is_kernel_vaddr (kpage) && is_user_vaddr (upage));
 
   lock_acquire (&ft_lock);
-  struct fte* fte = &ft[(kpage - (void*) get_user_pool_base ()) / PGSIZE];
+  struct fte* fte = ft_entry (kpage, true);
   fte->kpage = kpage;
   fte->pid = thread_tid ();
   fte->upage = upage;
@@ -58,8 +100,8 @@ ft_get (void* kpage)
   ASSERT (is_kernel_vaddr (kpage));
 
   lock_acquire (&ft_lock);
-  struct fte* fte = &ft[(kpage - (void*) get_user_pool_base ()) / PGSIZE];
-  void* result = fte->present ? fte->upage : NULL;
+  struct fte* fte = ft_entry (kpage, false);
+  void* result = fte != NULL && fte->present ? fte->upage : NULL;
   lock_release (&ft_lock);
 
   return result;
@@ -72,9 +114,10 @@ ft_remove (void* kpage)
   ASSERT (is_kernel_vaddr (kpage));
 
   lock_acquire (&ft_lock);
-  struct fte* fte = &ft[(kpage - (void*) get_user_pool_base ()) / PGSIZE];
-  void* result = fte->present ? fte->upage : NULL;
-  fte->present = false;
+  struct fte* fte = ft_entry (kpage, false);
+  void* result = fte != NULL && fte->present ? fte->upage : NULL;
+  if (fte != NULL)
+    fte->present = false;
   lock_release (&ft_lock);
 
   return result;
@@ -87,7 +130,7 @@ ft_pin (void* kpage)
   ASSERT (is_kernel_vaddr (kpage));
 
   lock_acquire (&ft_lock);
-  struct fte* fte = &ft[(kpage - (void*) get_user_pool_base ()) / PGSIZE];
+  struct fte* fte = ft_entry (kpage, true);
   fte->pinned = true;
   lock_release (&ft_lock);
 }
@@ -99,28 +142,19 @@ ft_unpin (void* kpage)
   ASSERT (is_kernel_vaddr (kpage));
 
   lock_acquire (&ft_lock);
-  struct fte* fte = &ft[(kpage - (void*) get_user_pool_base ()) / PGSIZE];
-  fte->pinned = false;
+  struct fte* fte = ft_entry (kpage, false);
+  if (fte != NULL)
+    fte->pinned = false;
   lock_release (&ft_lock);
 }
 
 void*
 falloc_get_frame (enum palloc_flags flags)
 {
-  struct lock* lock = get_user_pool_lock ();
-  struct bitmap* bitmap = get_user_pool_bitmap ();
-  uint8_t* base = get_user_pool_base ();
   void* kpage;
-  size_t kpage_idx;
 
-  lock_acquire (lock);
-  kpage_idx = bitmap_scan_and_flip (bitmap, 0, 1, false);
-  lock_release (lock);
-
-  if (kpage_idx != BITMAP_ERROR)
-    kpage = base + PGSIZE * kpage_idx;
-  else
-    kpage = NULL;
+  /* go through palloc so the buddy free lists stay in sync */
+  kpage = palloc_get_page (PAL_USER | PAL_TAG (MEM_FRAME));
 
   ASSERT (kpage == NULL || is_kernel_vaddr (kpage));
 
@@ -136,15 +170,17 @@ falloc_get_frame (enum palloc_flags flags)
 
     struct fte victim = ft[victim_idx];
 
-    lock_acquire (lock);
-    size_t cycle = bitmap_size (bitmap);
-    lock_release (lock);
+    size_t cycle = ft_cnt;
 
     size_t i;
     for (i = 0; i < 2 * cycle; i++)
     {
+      if (victim_idx >= cycle)
+        victim_idx = 0;
       victim = ft[victim_idx];
-      if (pagedir_is_accessed (thread_from_tid (victim.pid)->pagedir, victim.upage))
+      if (!victim.present)
+        ;	/* kernel page or free frame */
+      else if (pagedir_is_accessed (thread_from_tid (victim.pid)->pagedir, victim.upage))
         pagedir_set_accessed (thread_from_tid (victim.pid)->pagedir, victim.upage, false);
       else if (!victim.pinned)
         break;
@@ -186,6 +222,9 @@ falloc_get_frame (enum palloc_flags flags)
           spt_set_kernel (victim.pid, victim.upage, slot, SPTE_SWAP, writable);
         }
         break;
+      case SPTE_SHM:
+        PANIC ("shared frames are not in the frame table");
+        break;
       case SPTE_SWAP:
         //printf ("##########PID %d upage %#x kpage %#x################\n", victim.pid, (unsigned) victim.upage, (unsigned) victim.kpage);
         PANIC ("why are you in the swap?");
@@ -196,7 +235,7 @@ falloc_get_frame (enum palloc_flags flags)
     }
     pagedir_clear_page (thread_from_tid (victim.pid)->pagedir, victim.upage);
     //printf ("eviction pid %d upage %#x kpage %#x flag %d writable %d\n", victim.pid, (unsigned) victim.upage, (unsigned) victim.kpage, flag, writable);
-    kpage = base + PGSIZE * victim_idx;
+    kpage = palloc_page_addr (victim_idx);
   }
 
   lock_release (&ft_lock);
@@ -204,6 +243,10 @@ falloc_get_frame (enum palloc_flags flags)
   return kpage;
 }
 
+/* frees KPAGE and its frame table entry.  a frame fresh from
+   eviction still carries the old owner's entry until ft_set, and
+   once freed the page may go to the kernel pool, so the entry must
+   not outlive it */
 void
 falloc_free_frame (void* kpage)
 {
@@ -211,6 +254,12 @@ falloc_free_frame (void* kpage)
   ASSERT (pg_ofs (kpage) == 0);
   ASSERT (is_kernel_vaddr (kpage));
   lock_acquire (&ft_lock);
+  struct fte* fte = ft_entry (kpage, false);
+  if (fte != NULL)
+  {
+    fte->present = false;
+    fte->pinned = false;
+  }
   palloc_free_page (kpage);
   lock_release (&ft_lock);
 }
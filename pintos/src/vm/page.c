@@ -2,6 +2,7 @@
 #include "vm/swap.h"
 #include "threads/thread.h"
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 #include "filesys/file.h"
@@ -20,7 +21,8 @@ struct spte
 
 static struct hash spt;
 static struct hash_iterator spt_iterator;
-static struct lock spt_lock;
+static struct rwlock spt_lock;	/* lookups read, changes write */
+static struct kmem_cache* spte_cache;	/* exact-size spte objects */
 static unsigned spte_hash_func (const struct hash_elem*, void*);
 static bool spte_less_func (const struct hash_elem*, const struct hash_elem*, void*);
 
@@ -28,7 +30,8 @@ void
 spt_init (void)
 {
   hash_init (&spt, spte_hash_func, spte_less_func, NULL);
-  lock_init (&spt_lock);
+  rwlock_init (&spt_lock);
+  spte_cache = kmem_cache_create ("spte", sizeof (struct spte), NULL);
 }
 
 void
@@ -43,33 +46,36 @@ spt_set_kernel (tid_t pid, void* vaddr, void* ref, enum spte_flag flag, bool wri
   ASSERT (pg_ofs (vaddr) == 0);
   ASSERT (vaddr != NULL);
   ASSERT (flag != SPTE_INVALID);
-  struct spte* spte = malloc (sizeof *spte);
+  struct spte* spte = kmem_cache_alloc (spte_cache);
+  if (spte == NULL)
+    PANIC ("out of memory for spte");
   spte->pid = pid;
   spte->vaddr = vaddr;
   spte->ref = ref;
   spte->flag = flag;
   spte->writable = writable;
 
-  lock_acquire (&spt_lock);
-  hash_replace (&spt, &spte->elem);
+  rwlock_acquire_write (&spt_lock);
+  struct hash_elem* old = hash_replace (&spt, &spte->elem);
+  if (old != NULL)
+    kmem_cache_free (spte_cache, hash_entry (old, struct spte, elem));
   //printf ("spt_set pid %d upage %#x ref %#x flag %d writable %d\n", spte->pid, (unsigned) vaddr, (unsigned) ref, flag, writable);
-  lock_release (&spt_lock);
+  rwlock_release_write (&spt_lock);
 }
 
 void*
 spt_get_ref_kernel (tid_t pid, void* vaddr)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte = malloc (sizeof *spte);
-  spte->pid = pid;
-  spte->vaddr = vaddr;
+  struct spte key;
+  key.pid = pid;
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte->elem);
+  rwlock_acquire_read (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   void* ref = target != NULL ? hash_entry (target, struct spte, elem)->ref : NULL;
-  lock_release (&spt_lock);
+  rwlock_release_read (&spt_lock);
 
-  free (spte);
   return ref;
 }
 
@@ -83,16 +89,15 @@ enum spte_flag
 spt_get_flag_kernel (tid_t pid, void* vaddr)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte = malloc (sizeof *spte);
-  spte->pid = pid;
-  spte->vaddr = vaddr;
+  struct spte key;
+  key.pid = pid;
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte->elem);
+  rwlock_acquire_read (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   enum spte_flag flag = target != NULL ? hash_entry (target, struct spte, elem)->flag : SPTE_INVALID;
-  lock_release (&spt_lock);
+  rwlock_release_read (&spt_lock);
 
-  free (spte);
   return flag;
 }
 
@@ -106,16 +111,15 @@ bool
 spt_get_writable_kernel (tid_t pid, void* vaddr)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte = malloc (sizeof *spte);
-  spte->pid = pid;
-  spte->vaddr = vaddr;
+  struct spte key;
+  key.pid = pid;
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte->elem);
+  rwlock_acquire_read (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   bool writable = target != NULL ? hash_entry (target, struct spte, elem)->writable : false;
-  lock_release (&spt_lock);
+  rwlock_release_read (&spt_lock);
 
-  free (spte);
   return writable;
 }
 
@@ -129,20 +133,18 @@ void*
 spt_remove (void* vaddr)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte1 = malloc (sizeof *spte1);
-  spte1->pid = thread_tid ();
-  spte1->vaddr = vaddr;
+  struct spte key;
+  key.pid = thread_tid ();
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte1->elem);
+  rwlock_acquire_write (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   struct spte* spte2 = target != NULL ? hash_entry (target, struct spte, elem) : NULL;
   void* ref = spte2->ref;
 
   hash_delete (&spt, &spte2->elem);
-  free (spte2);
-  lock_release (&spt_lock);
-
-  free (spte1);
+  kmem_cache_free (spte_cache, spte2);
+  rwlock_release_write (&spt_lock);
 
   return ref;
 }
@@ -154,7 +156,7 @@ spt_free_process (tid_t pid)
   struct spte** entries = (struct spte**) malloc (hash_size (&spt) * 4);
   int entries_cnt = 0;
 
-  lock_acquire (&spt_lock);
+  rwlock_acquire_write (&spt_lock);
   hash_first (&spt_iterator, &spt);
   for (struct hash_elem* e = hash_cur (&spt_iterator); e != NULL; e = hash_next (&spt_iterator))
   {
@@ -173,6 +175,8 @@ spt_free_process (tid_t pid)
           break;
         case SPTE_ZERO:
           break;
+        case SPTE_SHM:
+          break;
         case SPTE_INVALID:
           PANIC ("who set you invalid?");
       }
@@ -183,9 +187,9 @@ spt_free_process (tid_t pid)
   for (int i = 0; i < entries_cnt; i++)
   {
     hash_delete (&spt, &entries[i]->elem);
-    free (entries[i]);
+    kmem_cache_free (spte_cache, entries[i]);
   }
-  lock_release (&spt_lock);
+  rwlock_release_write (&spt_lock);
 
   free (entries);
 }
@@ -194,39 +198,36 @@ void
 spte_file_seek (void* vaddr, off_t pos)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte = malloc (sizeof *spte);
-  spte->pid = thread_tid ();
-  spte->vaddr = vaddr;
+  struct spte key;
+  key.pid = thread_tid ();
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte->elem);
+  rwlock_acquire_write (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   struct spte* target_spte = target != NULL ? hash_entry (target, struct spte, elem) : NULL;
 
   ASSERT (target_spte != NULL);
   ASSERT (pos >= 0);
   target_spte->saved_file_pos = pos;
-  lock_release (&spt_lock);
-
-  free (spte);
+  rwlock_release_write (&spt_lock);
 }
 
 off_t
 spte_file_tell (void* vaddr)
 {
   ASSERT (pg_ofs (vaddr) == 0);
-  struct spte* spte = malloc (sizeof *spte);
-  spte->pid = thread_tid ();
-  spte->vaddr = vaddr;
+  struct spte key;
+  key.pid = thread_tid ();
+  key.vaddr = vaddr;
 
-  lock_acquire (&spt_lock);
-  struct hash_elem* target = hash_find (&spt, &spte->elem);
+  rwlock_acquire_read (&spt_lock);
+  struct hash_elem* target = hash_find (&spt, &key.elem);
   struct spte* target_spte = target != NULL ? hash_entry (target, struct spte, elem) : NULL;
 
   ASSERT (target_spte != NULL);
   off_t result = target_spte->saved_file_pos;
-  lock_release (&spt_lock);
+  rwlock_release_read (&spt_lock);
 
-  free (spte);
   return result;
 }
 
@@ -5,12 +5,16 @@
 #include "threads/thread.h"
 #include "filesys/off_t.h"
 
+/* user stack may grow down this far below PHYS_BASE */
+#define STACK_LIMIT (1 << 23)
+
 enum spte_flag
 {
   SPTE_MMRY = 0,
   SPTE_FILE = 1,
   SPTE_SWAP = 2,
   SPTE_ZERO = 3,
+  SPTE_SHM = 4,		/* ref is a struct shm, file pos the offset in it */
   SPTE_INVALID = 99
 };
 
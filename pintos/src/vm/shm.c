@@ -0,0 +1,182 @@
+#include "vm/shm.h"
+#include "vm/frame.h"
+#include <list.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "filesys/inode.h"
+#include "lib/kernel/bitmap.h"
+
+struct shm
+{
+  int key;			/* anonymous objects: name given by the user */
+  struct inode* inode;		/* file objects: the file mapped */
+  struct file* file;		/* own handle to load and write back */
+  size_t page_cnt;
+  void** kpages;		/* frames, NULL until first touched */
+  struct bitmap* dirty;		/* pages written through some mapping */
+  int ref_cnt;			/* mappings referring to this object */
+  struct list_elem elem;
+};
+
+/* named objects, found again by key or inode */
+static struct list shm_list;
+static struct lock shm_lock;
+
+/* shared frames cannot be evicted, so at most 1/SHM_FRACTION of
+   the user pool may hold them at once.  past that, touching a new
+   shared page kills the process that touched it instead of
+   leaving the clock with nothing to evict for everyone else */
+#define SHM_FRACTION 2
+static size_t shm_resident;	/* frames held by all objects */
+
+void
+shm_init (void)
+{
+  list_init (&shm_list);
+  lock_init (&shm_lock);
+}
+
+/* returns the object for FILE, or for KEY if FILE is NULL, with a
+   new reference taken.  it is created with PAGE_CNT pages if no
+   process has it mapped yet.  key 0 always makes a fresh object
+   nobody else can find.  returns NULL if the object exists but is
+   smaller than PAGE_CNT, or if memory runs out */
+struct shm*
+shm_open (int key, struct file* file, size_t page_cnt)
+{
+  struct inode* inode = file != NULL ? file_get_inode (file) : NULL;
+  struct list_elem* e;
+  struct shm* shm;
+
+  lock_acquire (&shm_lock);
+  if (file != NULL || key != 0)
+    for (e = list_begin (&shm_list); e != list_end (&shm_list); e = list_next (e))
+    {
+      shm = list_entry (e, struct shm, elem);
+      if (file != NULL ? shm->inode == inode : shm->inode == NULL && shm->key == key)
+      {
+        if (shm->page_cnt < page_cnt)
+          shm = NULL;
+        else
+          shm->ref_cnt++;
+        lock_release (&shm_lock);
+        return shm;
+      }
+    }
+
+  shm = malloc (sizeof *shm);
+  if (shm == NULL)
+    goto fail;
+  shm->key = key;
+  shm->inode = inode;
+  shm->file = NULL;
+  shm->page_cnt = page_cnt;
+  shm->kpages = calloc (page_cnt, sizeof *shm->kpages);
+  shm->dirty = bitmap_create (page_cnt);
+  if (file != NULL)
+    shm->file = file_reopen (file);
+  if (shm->kpages == NULL || shm->dirty == NULL
+      || (file != NULL && shm->file == NULL))
+  {
+    if (shm->dirty != NULL)
+      bitmap_destroy (shm->dirty);
+    free (shm->kpages);
+    file_close (shm->file);
+    free (shm);
+    goto fail;
+  }
+  shm->ref_cnt = 1;
+  if (file != NULL || key != 0)
+    list_push_back (&shm_list, &shm->elem);
+  lock_release (&shm_lock);
+  return shm;
+
+ fail:
+  lock_release (&shm_lock);
+  return NULL;
+}
+
+/* drops a reference to SHM.  the last one writes dirty pages back
+   to the file, if any, and frees the frames */
+void
+shm_close (struct shm* shm)
+{
+  lock_acquire (&shm_lock);
+  if (--shm->ref_cnt > 0)
+  {
+    lock_release (&shm_lock);
+    return;
+  }
+  if (shm->file != NULL || shm->key != 0)
+    list_remove (&shm->elem);
+  lock_release (&shm_lock);
+
+  off_t length = shm->file != NULL ? file_length (shm->file) : 0;
+  size_t freed = 0;
+  for (size_t i = 0; i < shm->page_cnt; i++)
+  {
+    void* kpage = shm->kpages[i];
+    if (kpage == NULL)
+      continue;
+    off_t ofs = i * PGSIZE;
+    if (shm->file != NULL && bitmap_test (shm->dirty, i) && ofs < length)
+      file_write_at (shm->file, kpage,
+                     length - ofs < PGSIZE ? length - ofs : PGSIZE, ofs);
+    falloc_free_frame (kpage);
+    freed++;
+  }
+  lock_acquire (&shm_lock);
+  shm_resident -= freed;
+  lock_release (&shm_lock);
+  file_close (shm->file);
+  bitmap_destroy (shm->dirty);
+  free (shm->kpages);
+  free (shm);
+}
+
+/* returns the frame holding page IDX of SHM, bringing it in first
+   if no process has touched it yet, or NULL if no frame is free or
+   shared frames already fill their share of the user pool.
+   shared frames stay out of the frame table, so eviction never
+   picks them: they live until the last mapping goes away */
+void*
+shm_get_page (struct shm* shm, size_t idx)
+{
+  ASSERT (idx < shm->page_cnt);
+
+  lock_acquire (&shm_lock);
+  void* kpage = shm->kpages[idx];
+  if (kpage == NULL && shm_resident < palloc_user_limit () / SHM_FRACTION)
+  {
+    kpage = falloc_get_frame (0);
+    if (kpage != NULL)
+    {
+      /* an evicted frame still carries its old owner's entry */
+      ft_remove (kpage);
+      off_t read_bytes = 0;
+      if (shm->file != NULL)
+        read_bytes = file_read_at (shm->file, kpage, PGSIZE, idx * PGSIZE);
+      memset (kpage + read_bytes, 0, PGSIZE - read_bytes);
+      shm->kpages[idx] = kpage;
+      shm_resident++;
+    }
+  }
+  lock_release (&shm_lock);
+
+  return kpage;
+}
+
+/* notes that page IDX of SHM was written, so it goes back to the
+   file when the object is freed */
+void
+shm_set_dirty (struct shm* shm, size_t idx)
+{
+  ASSERT (idx < shm->page_cnt);
+
+  lock_acquire (&shm_lock);
+  bitmap_mark (shm->dirty, idx);
+  lock_release (&shm_lock);
+}
@@ -0,0 +1,18 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/file.h"
+
+/* shared memory object: the frames behind a MAP_SHARED mapping,
+   referenced by every process that maps it */
+struct shm;
+
+void shm_init (void);
+struct shm* shm_open (int, struct file*, size_t);
+void shm_close (struct shm*);
+void* shm_get_page (struct shm*, size_t);
+void shm_set_dirty (struct shm*, size_t);
+
+#endif /* vm/shm.h */
@@ -39,6 +39,17 @@ swap_in (void* slot, void* buf)
   return true;
 }
 
+/* releases SLOT without reading it back */
+void
+swap_free (void* slot)
+{
+  lock_acquire (&swap_lock);
+  size_t start = (slot - (void*) swap_block) / BLOCK_SECTOR_SIZE;
+  ASSERT (bitmap_all (st, start, SLOT_CNT));
+  bitmap_set_multiple (st, start, SLOT_CNT, false);
+  lock_release (&swap_lock);
+}
+
 void*
 swap_out (const void* buf)
 {
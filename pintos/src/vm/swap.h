@@ -6,5 +6,6 @@
 void swap_init (void);
 bool swap_in (void*, void*);
 void* swap_out (const void*);
+void swap_free (void*);
 
 #endif /* vm/swap.h */